@@ -5,7 +5,7 @@
  * https://github.com/jgOhYeah/BikeHorn
  * 
  * Written by Jotham Gates
- * Last modified 27/01/2023
+ * Last modified 18/10/2026
  * 
  * Requires these libraries (can be installed through the library manager):
  *   - Low-Power (https://github.com/rocketscream/Low-Power) - Shuts things down to save power.
@@ -17,6 +17,7 @@
  */
 
 #include "defines.h"
+#include "src/trace.h"
 
 // Prototypes so that the extension manager is happy
 void uiBeep(uint16_t* beep);
@@ -30,6 +31,9 @@ void wakeGPIO();
 
 #include "tunes.h"
 #include "src/optimisations.h"
+#include "src/power.h"
+#include "src/clock.h"
+#include "src/boost.h"
 #include "src/soundGeneration.h"
 #include "src/soundGenerationStatic.h"
 
@@ -38,6 +42,8 @@ BikeHornSound piezo;
 TunePlayer tune;
 uint8_t curTune = 0;
 period_t sleepTime = SLEEP_FOREVER;
+bool started = false; // Set once finishStartup() has run.
+uint32_t readyTime; // micros() when setup() finished, so the time since timer 0 started (not including the bootloader).
 
 #ifdef ENABLE_WARBLE
 Warble warble;
@@ -48,27 +54,49 @@ volatile Buttons wakePin;
 
 #include "src/extensions/extensions.h"
 
+#ifdef ENABLE_RIDE_DETECTION
+#include "src/rideDetector.h"
+RideDetector rideDetector;
+#endif
+
 void setup() {
     WATCHDOG_ENABLE;
+    PowerManager::begin(); // Switch off everything that isn't needed yet
     sleepGPIO(); // Shutdown the timers if the horn crashed previously
     wakeGPIO();
-    Serial.println(F(WELCOME_MSG));
-    Serial.print(F("There are "));
-    Serial.print(tuneCount);
-    Serial.println(F(" tunes installed"));
 
-    // Tune Player
+    // Only what is needed to play the horn. Everything else waits until the horn is idle (see finishStartup()), so
+    // that a horn that was reset (brown out) while riding can be used straight away.
     flashLoader.setTune((uint16_t*)pgm_read_word(&(tunes[curTune])));
     tune.begin(&flashLoader, &piezo);
     tune.spool();
 
-    // Extensions
-    extensionManager.callOnStart();
-
 #ifdef ENABLE_WARBLE
     /// Warble mode
     warble.begin(&piezo, WARBLE_LOWER, WARBLE_UPPER, WARBLE_RISE, WARBLE_FALL);
 #endif
+    readyTime = micros();
+}
+
+/**
+ * @brief Prints the startup messages and starts the extensions. Called the first time the horn is idle after
+ * starting up.
+ * 
+ */
+void finishStartup() {
+    Serial.println(F(WELCOME_MSG));
+#ifdef ENABLE_WATCHDOG_FORENSICS
+    WatchdogMonitor::report();
+#endif
+    Serial.print(F("Ready to play after (us): "));
+    Serial.println(readyTime);
+    Serial.print(F("There are "));
+    Serial.print(tuneCount);
+    Serial.println(F(" tunes installed"));
+    piezo.printSettings();
+
+    // Extensions
+    extensionManager.callOnStart();
 }
 
 void loop() {
@@ -84,13 +112,25 @@ void loop() {
                 break;
             }
         }
+        if (!started) {
+            // First time idle since starting up.
+            started = true;
+            finishStartup();
+            return; // Check the horn button again before going to sleep
+        }
         Serial.println(F("Going to sleep"));
         extensionManager.callOnSleep();
         sleepGPIO();
         wakeUpEnable();
         WATCHDOG_DISABLE;
+        TRACE(TRACE_SLEEP, 0);
+#ifdef ENABLE_RIDE_DETECTION
+        rideDetector.sleep(); // Only returns when a button is pressed
+#else
         LowPower.powerDown(sleepTime, ADC_OFF, BOD_OFF); // The horn will spend most of its life here
+#endif
         wakeUpDisable();
+        TRACE(TRACE_WAKE, wakePin);
         WATCHDOG_ENABLE;
         wakeGPIO();
         Serial.println(F("Waking up"));
@@ -105,6 +145,7 @@ void loop() {
         extensionManager.callOnTuneStart();
         // Start playing
         startBoost();
+        TRACE(TRACE_TUNE_PLAY, curTune);
 #ifdef ENABLE_WARBLE
         if(curTune != tuneCount) {
             // Normal tune playing mode
@@ -214,12 +255,20 @@ void loop() {
  */
 void sleepGPIO() {
     // Shut down timers to release pins
-    TCCR1A = 0;
-    TCCR1B = 0;
-    stopBoost();
+    if (piezo.isPlaying()) {
+        TCCR1A = 0;
+        TCCR1B = 0;
+        PowerManager::release(POWER_TIMER1);
+    }
+    if (!BoostManager::isKeptWarm()) {
+        stopBoost(); // Otherwise left running while riding (see RideDetector)
+    }
 
     // Shutdown serial so it won't be affected by playing with the io lines
-    Serial.end();
+    if (PowerManager::isOn(POWER_USART)) {
+        Serial.end();
+        PowerManager::release(POWER_USART);
+    }
 
     // Using registers so everything can be done at once easily.
     DDRB = bit(PB1) | bit(PB3); // Set everything except pwm to input pullup
@@ -247,8 +296,12 @@ void sleepGPIO() {
  * Wakes and sets up the GPIO and peripheries.
  */
 void wakeGPIO() {
+    ClockManager::fast(); // Serial.begin() assumes the full clock speed
     DDRD = 0x02; // Serial TX is the only output
     PORTD = 0x0E; // Idle high serial
+    if (!PowerManager::isOn(POWER_USART)) {
+        PowerManager::acquire(POWER_USART);
+    }
     Serial.begin(SERIAL_BAUD);
     DDRB = bit(PB1) | bit(PB3);
     PORTB = 0x00; // Make sure everything is off
@@ -275,6 +328,8 @@ void wakeUpDisable() {
  */
 void wakeUpHornISR() {
     wakePin = PRESSED_HORN;
+    TRACE(TRACE_BUTTON, PRESSED_HORN);
+    BoostManager::start(); // Get the boost charging while everything else wakes up
 }
 
 /**
@@ -282,18 +337,15 @@ void wakeUpHornISR() {
  */
 void wakeUpModeISR() {
     wakePin = PRESSED_MODE;
+    TRACE(TRACE_BUTTON, PRESSED_MODE);
 }
 
 /**
- * Sets up and starts the intermediate boost stage.
+ * Starts the intermediate boost stage (soft starting it if it was off) and
+ * cancels any idle timeout.
  */
 void startBoost() {
-    // Set PB3 to be an output (Pin11 Arduino UNO)
-    DDRB |= (1 << PB3);
-    
-    TCCR2A = (1 << COM2A1) | (1 << WGM21) | (1 << WGM20); // Mode 3, fast PWM, reset at 255
-    TCCR2B = (1<< CS20); // Prescalar 1
-    OCR2A = IDLE_DUTY; // Enough duty cycle to keep the voltage on the second stage at a reasonable level.
+    BoostManager::wake();
 }
 
 /**
@@ -301,8 +353,7 @@ void startBoost() {
  * 
  */
 inline void stopBoost() {
-    TCCR2A = 0;
-    TCCR2B = 0;
+    BoostManager::stop();
 }
 
 /**
@@ -318,6 +369,7 @@ uint32_t modeButtonPress() {
     while(millis() - debounceTime < DEBOUNCE_TIME) {
         WATCHDOG_RESET;
         tune.update();
+        ClockManager::slow(); // Only waiting for a button if nothing is playing
         if(IS_PRESSED(BUTTON_MODE)) {
             debounceTime = millis();
         }
@@ -338,6 +390,7 @@ uint32_t modeButtonPress() {
  * @param beep the new tune.
  */
 void uiBeep(uint16_t* beep) {
+    TRACE(TRACE_TUNE_PLAY, 0xffff);
     tune.stop();
     tune.setCallOnStop(revertToTune);
     flashLoader.setTune(beep);
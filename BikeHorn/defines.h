@@ -5,7 +5,7 @@
  * https://github.com/jgOhYeah/BikeHorn
  * 
  * Written by Jotham Gates
- * Last modified 27/06/2023
+ * Last modified 18/10/2026
  */
 
 #pragma once
@@ -24,11 +24,22 @@
 #define SERIAL_BAUD 38400
 
 #define IDLE_DUTY 5 // 9.4% duty cycle, keeps the voltage up when not playing
+#define BOOST_PRECHARGE_DUTY 30 // Boost duty to ramp up to as soon as the horn button is pressed
+#define BOOST_PRECHARGE_TIME 50 // Drop back to IDLE_DUTY if nothing has played this many 1.024ms ticks after the precharge
+#define BOOST_SOFT_START_STEP 4 // Boost duty to increase by each 1.024ms when soft starting
+#define BOOST_IDLE_TIMEOUT 5000 // Turn the boost off after nothing has played for this many 1.024ms ticks
 #define MIDI_CHANNEL 0 // Zero indexed, so many software shows ch. 0 as ch. 1
+#define MIDI_BAUD SERIAL_BAUD // Baud rate in MIDI synth mode. Use 31250 for a standard MIDI input, or SERIAL_BAUD for a USB serial to MIDI bridge.
 #define DEBOUNCE_TIME 20
 
+// Clock scaling. Serial only works at the slower clock speed if SERIAL_BAUD is 19200 or lower (38400 can't be made at
+// 2MHz), so with faster baud rates the clock is only slowed while serial is off (the burgler alarm's sleep state).
+#define ENABLE_CLOCK_SCALING // Define this to run the CPU at 2MHz while waiting for buttons or the accelerometer.
+
 // Watchdog timer to reduce lockups with a flat battery / unstable power supply
 #define ENABLE_WATCHDOG_TIMER // DO NOT enable this (uncomment it) for Arduinos running the older (pre optiboot) bootloader as this will cause lockups
+#define ENABLE_WATCHDOG_FORENSICS // Define this to print where the horn was stuck after a watchdog reset (see Documentation/Tracing.md).
+#define WATCHDOG_CAPTURE_TICKS 3000 // 1.024ms ticks without a watchdog reset before saving what was happening (it resets at 4s).
 
 /**
  * @brief Warble mode settings
@@ -43,15 +54,57 @@
 #define WARBLE_STEP 10 // Number of timer 1 counts to step at a time (need to keep time between steps high enough to not
                        // get bogged down as each update now takes ~100us with eeprom piecewise)
 
+/**
+ * @brief Sample playback settings
+ * 
+ */
+// #define ENABLE_SAMPLES // Define this to add a menu item that plays the recorded sounds in samples.h (see
+                          // Documentation/Samples.md). The included sample uses around 1.6kB of flash.
+#define SAMPLE_MAX_DUTY 128 // Piezo duty at the loudest point of a sample (out of 256)
+#define SAMPLE_BOOST_DUTY 40 // Boost duty while a sample is playing (out of 255)
+
+/**
+ * @brief Ride detection settings
+ * 
+ */
+// #define ENABLE_RIDE_DETECTION // Define this to use the accelerometer to keep the boost warm while riding (needs
+                                 // ACCEL_INSTALLED). Idling with the boost warm draws around 3.3mA, so with
+                                 // Tools/powerSimulator.py's default profile (two 30 minute rides a day) the average
+                                 // current goes from 16uA to 147uA and the battery life from about 4000 to 550 days.
+#define RIDE_MOTION_THRESHOLD 12 // Total ADC counts the 3 axes have to change by between samples to count as moving.
+#define RIDE_SCORE_MOVED 4 // Score added for each sample that moved.
+#define RIDE_SCORE_RIDING 8 // Score needed to count as riding. Each quiet sample takes 1 off until parked at 0.
+#define RIDE_SCORE_MAX 60 // Highest score, so the longest time riding lasts after stopping is this many samples.
+#define RIDE_SAMPLE_PERIOD SLEEP_1S // Time between samples while riding.
+#define RIDE_PARKED_PERIOD SLEEP_8S // Time between samples while parked.
+#define RIDE_DEEP_SLEEP_SAMPLES 75 // Quiet samples while parked before only waking for a button (75 * 8s = 10 min).
+
 /**
  * @brief Logging and EEPROM settings
  * 
  */
 #define LOG_RUN_TIME // Define this if you want to keep a record of run time when in horn mode for battery usage analysis.
+#define EEPROM_RECORD_OVERHEAD 5 // Header and CRC bytes around each record (see src/recordStore.h).
 #define EEPROM_PIECEWISE_SIZE 81 // 1 length byte + 10 linear functions for a piecewise function
-#define EEPROM_TIMER1_PIECEWISE 0x35e // Near the end so that the wear levelling can have the start
-#define EEPROM_TIMER2_PIECEWISE EEPROM_TIMER1_PIECEWISE + EEPROM_PIECEWISE_SIZE
 #define EEPROM_PIECEWISE_MAX_LENGTH 10 // Max number of functions piecewise function for sanity checking before allocating ram.
+#define EEPROM_ALARM_LOG_RECORDS 4 // Number of burgler alarm triggers to keep.
+#define EEPROM_ALARM_LOG_SIZE 224 // EEPROM_ALARM_LOG_RECORDS records of 56 bytes each (see triggerLog.h).
+
+// EEPROM layout, from the end down so that the wear levelling can have the start. The optimiser settings addresses
+// need to match Tuning/BikeHornOptimiser.py.
+#define EEPROM_TIMER2_PIECEWISE (E2END + 1 - EEPROM_PIECEWISE_SIZE - EEPROM_RECORD_OVERHEAD) // Record
+#define EEPROM_TIMER1_PIECEWISE (EEPROM_TIMER2_PIECEWISE - EEPROM_PIECEWISE_SIZE - EEPROM_RECORD_OVERHEAD) // Record
+#define EEPROM_ACCEL_SETTLE (EEPROM_TIMER1_PIECEWISE - 1 - EEPROM_RECORD_OVERHEAD) // Record. period_t to wait for the accelerometer to start up.
+#define EEPROM_OUTPUT_PROFILE (EEPROM_ACCEL_SETTLE - 1 - EEPROM_RECORD_OVERHEAD) // Record. Selected output profile.
+#define EEPROM_ALARM_LOG (EEPROM_OUTPUT_PROFILE - EEPROM_ALARM_LOG_SIZE) // Ring of trigger records with their own format (see triggerLog.h).
+
+/**
+ * @brief Debugging
+ * 
+ */
+// #define ENABLE_TRACE // Define this to record trace events (see Documentation/Tracing.md). Uses TRACE_LENGTH * 7 bytes of RAM.
+#define TRACE_LENGTH 32 // Number of events to keep. Must be a power of 2 and 128 or less.
+// #define RAM_DEBUG // Define this to print RAM usage on startup and from the menu, including the deepest the stack has been.
 
 /**
  * @brief User interface
@@ -97,10 +150,20 @@ enum Buttons {PRESSED_NONE, PRESSED_HORN, PRESSED_MODE};
 // Only needed for the watchdog timer (DO NOT enable for Arduinos with the old bootloader).
 #ifdef ENABLE_WATCHDOG_TIMER
     #include <avr/wdt.h>
-    #define WATCHDOG_ENABLE wdt_enable(WDTO_4S)
-    #define WATCHDOG_DISABLE wdt_disable()
-    #define WATCHDOG_RESET wdt_reset()
+    #ifdef ENABLE_WATCHDOG_FORENSICS
+        #include "src/watchdog.h"
+        #define WATCHDOG_ENABLE WatchdogMonitor::enable()
+        #define WATCHDOG_DISABLE WatchdogMonitor::disable()
+        #define WATCHDOG_RESET WatchdogMonitor::reset()
+    #else
+        #define WATCHDOG_ENABLE wdt_enable(WDTO_4S)
+        #define WATCHDOG_DISABLE wdt_disable()
+        #define WATCHDOG_RESET wdt_reset()
+    #endif
 #else
+    #ifdef ENABLE_WATCHDOG_FORENSICS
+        #error "ENABLE_WATCHDOG_FORENSICS needs ENABLE_WATCHDOG_TIMER"
+    #endif
     #define WATCHDOG_ENABLE
     #define WATCHDOG_DISABLE
     #define WATCHDOG_RESET
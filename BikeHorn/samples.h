@@ -0,0 +1,121 @@
+/** samples.h
+ * Recorded sounds for the horn to play (see Documentation/Samples.md). Convert
+ * each sound with Tools/sampleEncoder.py, paste it in here, then add it to the
+ * samples array at the bottom.
+ * 
+ * For more details, see README.md or go to
+ * https://github.com/jgOhYeah/BikeHorn
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "src/samplePlayer.h"
+
+// Converted from 'honk.wav (synthesised two tone horn)' by sampleEncoder.py. 0.30s at 10417Hz, 1563 bytes.
+const uint8_t honkData[] PROGMEM = {
+    0x30,0x36,0xff,0x19,0x53,0xc3,0xaa,0x5d,0x08,0x08,0x38,0xb8,0xf0,0x5f,0x12,0xb8,
+    0x8e,0x48,0x03,0xe8,0x0a,0x21,0x85,0x8b,0x19,0x00,0x08,0x08,0xa7,0xb9,0x3c,0x63,
+    0x91,0xae,0x08,0x35,0x88,0xad,0x30,0x50,0xb8,0xc8,0x03,0x08,0x80,0x58,0x0b,0xbc,
+    0x34,0x05,0xe9,0x0a,0x70,0x01,0xeb,0x08,0x24,0xb1,0x09,0x3b,0x08,0x08,0x48,0xf3,
+    0xd8,0x30,0x41,0xc0,0x0c,0x18,0x17,0xc0,0x8b,0x22,0x23,0x9d,0x99,0x84,0x80,0x80,
+    0x92,0x89,0x9f,0x35,0x01,0xcd,0x80,0x26,0x90,0xad,0x28,0x43,0xc8,0xa0,0x82,0x80,
+    0x80,0x70,0x8b,0xba,0x24,0x14,0xea,0x0a,0x70,0x01,0xe9,0x89,0x04,0x94,0x8a,0x3c,
+    0x80,0x00,0x88,0xb4,0xd0,0x4a,0x33,0xb0,0xaf,0x10,0x07,0xc0,0x0c,0x48,0x03,0x9b,
+    0xb0,0x03,0x08,0x08,0x05,0x8c,0x0f,0x13,0x03,0xbe,0x88,0x72,0x00,0xcc,0x20,0x41,
+    0xc0,0x98,0x28,0x80,0x80,0x40,0x8b,0xf9,0x40,0x03,0xe0,0x8b,0x70,0x01,0xda,0x89,
+    0x23,0x94,0x0b,0x3b,0x08,0x08,0x08,0xb7,0xc8,0x5a,0x41,0xa0,0x9d,0x18,0x17,0xa0,
+    0x9d,0x30,0x32,0xca,0xe0,0x03,0x08,0x08,0x48,0x0b,0x9d,0x24,0x03,0xfb,0x89,0x72,
+    0x00,0xbd,0x00,0x34,0xc0,0x88,0x29,0x08,0x08,0x58,0xb8,0xf9,0x31,0x31,0xf8,0x0b,
+    0x68,0x03,0xd8,0x0b,0x03,0x05,0x0c,0x1b,0x82,0x80,0x08,0xb4,0xa8,0x1f,0x53,0x80,
+    0xad,0x88,0x27,0xa0,0x9d,0x38,0x33,0xca,0xb0,0x03,0x08,0x88,0x71,0x8b,0x8e,0x04,
+    0x03,0xeb,0x88,0x70,0x01,0xea,0x19,0x13,0xb3,0x9a,0x4d,0x80,0x80,0x00,0xa1,0xf8,
+    0x59,0x12,0xb0,0x8e,0x48,0x04,0xd8,0x8a,0x31,0x05,0x0c,0x89,0x01,0x08,0x08,0xa6,
+    0x99,0x2d,0x32,0x92,0xbf,0x80,0x54,0x80,0xad,0x48,0x40,0xb8,0xb8,0x12,0x80,0x80,
+    0x50,0x0c,0xda,0x32,0x06,0xd8,0x8a,0x78,0x02,0xdb,0x88,0x24,0xa1,0x0a,0x3b,0x80,
+    0x80,0x20,0xc7,0xd8,0x48,0x30,0xc0,0x8c,0x08,0x17,0xb0,0x8d,0x21,0x32,0x9c,0xa9,
+    0x84,0x80,0x00,0x01,0x8a,0xaf,0x26,0x01,0xcc,0x88,0x35,0x90,0xad,0x28,0x52,0xb8,
+    0x98,0x01,0x80,0x80,0x70,0x9a,0xba,0x43,0x14,0xf9,0x8a,0x70,0x01,0xd9,0x8a,0x04,
+    0x84,0x8b,0x3c,0x80,0x80,0x80,0xb4,0xc0,0x4b,0x63,0x90,0xad,0x00,0x17,0xb0,0x8e,
+    0x40,0x12,0x9b,0xb0,0x83,0x80,0x80,0x34,0x8f,0x0d,0x13,0x04,0xcc,0x80,0x63,0x00,
+    0xbc,0x28,0x32,0xd2,0x99,0x49,0x08,0x08,0x28,0x99,0xf8,0x59,0x13,0xd0,0x0c,0x68,
+    0x02,0xd9,0x8a,0x32,0x84,0x0c,0x2a,0x08,0x08,0x08,0xb7,0xa8,0x4b,0x42,0xa1,0xae,
+    0x00,0x17,0x90,0x9e,0x48,0x40,0xa9,0xc8,0x03,0x08,0x80,0x48,0x0b,0xad,0x34,0x03,
+    0xfb,0x0a,0x71,0x00,0xcc,0x80,0x34,0xb0,0x09,0x3b,0x80,0x80,0x50,0xc0,0xf8,0x30,
+    0x31,0xe0,0x8b,0x78,0x02,0xd0,0x8b,0x13,0x14,0x8c,0x0a,0x82,0x80,0x80,0xb5,0x88,
+    0x0f,0x43,0x00,0xbd,0x08,0x17,0xa0,0x9d,0x38,0x42,0xb9,0xb0,0x83,0x80,0x80,0x70,
+    0x8b,0xac,0x15,0x04,0xda,0x89,0x70,0x01,0xda,0x09,0x23,0xa3,0x0c,0x3e,0x80,0x80,
+    0x80,0xb4,0xd0,0x49,0x32,0xb0,0x9f,0x28,0x07,0xd0,0x0b,0x40,0x03,0x8c,0x98,0x82,
+    0x80,0x80,0x85,0x9b,0x1f,0x13,0x83,0xbf,0x80,0x36,0x80,0xbd,0x30,0x50,0xc0,0xb0,
+    0x21,0x08,0x88,0x40,0x8b,0xfa,0x31,0x05,0xd8,0x8a,0x78,0x02,0xda,0x89,0x33,0xa3,
+    0x0c,0x3b,0x80,0x80,0x18,0xb7,0xe8,0x48,0x30,0xb0,0x8e,0x08,0x17,0xa0,0x9e,0x31,
+    0x31,0xab,0xd9,0x04,0x08,0x08,0x10,0x8a,0x9f,0x25,0x01,0xeb,0x88,0x44,0x80,0xad,
+    0x18,0x53,0xc0,0x90,0x18,0x80,0x80,0x60,0x9a,0xd9,0x22,0x23,0xf9,0x0b,0x48,0x05,
+    0xd8,0x8a,0x04,0x84,0x8b,0x2b,0x01,0x08,0x08,0xc5,0xa0,0x2d,0x63,0x80,0xad,0x88,
+    0x27,0xb0,0x8d,0x48,0x12,0xaa,0xb0,0x03,0x08,0x08,0x72,0x8c,0x8d,0x04,0x03,0xcc,
+    0x88,0x70,0x01,0xdb,0x18,0x22,0xc3,0x99,0x4a,0x08,0x08,0x10,0xa0,0xf8,0x6a,0x12,
+    0xc0,0x8c,0x58,0x03,0xd9,0x8a,0x22,0x85,0x8b,0x19,0x00,0x08,0x08,0xa7,0xa9,0x3b,
+    0x44,0x91,0xaf,0x08,0x17,0x90,0xad,0x48,0x40,0xb8,0xc8,0x03,0x08,0x08,0x48,0x0b,
+    0xbc,0x34,0x06,0xd9,0x0a,0x70,0x01,0xeb,0x08,0x24,0xb1,0x09,0x3b,0x08,0x08,0x48,
+    0xf3,0xd8,0x30,0x41,0xc0,0x0c,0x38,0x06,0xc0,0x8b,0x22,0x23,0x9d,0x99,0x84,0x80,
+    0x80,0x92,0x89,0x9f,0x35,0x01,0xcd,0x80,0x26,0x90,0xad,0x28,0x43,0xc8,0xa0,0x82,
+    0x80,0x80,0x70,0x8b,0xba,0x24,0x14,0xea,0x0a,0x70,0x01,0xe9,0x89,0x04,0x94,0x8a,
+    0x3c,0x80,0x00,0x88,0xb4,0xd0,0x4a,0x33,0xb0,0xaf,0x10,0x07,0xc0,0x0c,0x48,0x03,
+    0x9b,0xb0,0x03,0x08,0x08,0x05,0x8c,0x0f,0x13,0x03,0xbe,0x88,0x35,0x00,0xbd,0x38,
+    0x41,0xc1,0xa8,0x20,0x08,0x08,0x58,0x8b,0xf8,0x30,0x04,0xd0,0x8b,0x70,0x01,0xda,
+    0x89,0x23,0x94,0x0b,0x3b,0x08,0x08,0x08,0xb7,0xc8,0x5a,0x41,0xa0,0x9d,0x08,0x17,
+    0xa0,0x9d,0x30,0x32,0xca,0xe0,0x03,0x08,0x08,0x48,0x0b,0x9d,0x24,0x03,0xfb,0x89,
+    0x72,0x00,0xbd,0x00,0x34,0xc0,0x88,0x29,0x08,0x08,0x58,0xb8,0xf9,0x31,0x31,0xf8,
+    0x0b,0x68,0x03,0xd8,0x0b,0x03,0x05,0x0c,0x1b,0x82,0x80,0x08,0xb4,0xa8,0x1f,0x53,
+    0x80,0xad,0x88,0x27,0xa0,0x9d,0x38,0x33,0xca,0xb0,0x03,0x08,0x88,0x71,0x8b,0x8e,
+    0x04,0x03,0xeb,0x88,0x70,0x01,0xea,0x19,0x13,0xb3,0x9a,0x4d,0x80,0x80,0x00,0xa1,
+    0xf8,0x59,0x12,0xb0,0x8e,0x48,0x04,0xd8,0x8a,0x31,0x05,0x0c,0x89,0x01,0x08,0x08,
+    0xa6,0x99,0x2d,0x32,0x92,0xbf,0x80,0x27,0x80,0xbd,0x30,0x60,0xb8,0xb8,0x12,0x80,
+    0x80,0x50,0x0c,0xda,0x32,0x06,0xd8,0x8a,0x78,0x02,0xdb,0x88,0x24,0xa1,0x0a,0x3b,
+    0x80,0x80,0x20,0xc7,0xd8,0x48,0x30,0xc0,0x8c,0x08,0x17,0xb0,0x8d,0x21,0x32,0x9c,
+    0xa9,0x84,0x80,0x00,0x01,0x8a,0xaf,0x26,0x01,0xcc,0x88,0x35,0x90,0xad,0x28,0x52,
+    0xb8,0x98,0x01,0x80,0x80,0x70,0x9a,0xba,0x43,0x14,0xf9,0x8a,0x50,0x03,0xd9,0x8a,
+    0x04,0x84,0x8b,0x3c,0x80,0x80,0x80,0xb4,0xc0,0x4b,0x63,0x90,0xad,0x00,0x17,0xb0,
+    0x8e,0x40,0x12,0x9b,0xb0,0x83,0x80,0x80,0x34,0x8f,0x0d,0x13,0x04,0xcc,0x80,0x63,
+    0x00,0xbc,0x28,0x32,0xd2,0x99,0x49,0x08,0x08,0x28,0x99,0xf8,0x59,0x13,0xd0,0x0c,
+    0x68,0x02,0xd9,0x8a,0x32,0x84,0x0c,0x2a,0x08,0x08,0x08,0xb7,0xa8,0x4b,0x42,0xa1,
+    0xae,0x00,0x17,0x90,0x9e,0x48,0x40,0xa9,0xc8,0x03,0x08,0x80,0x48,0x0b,0xad,0x34,
+    0x03,0xfb,0x0a,0x71,0x00,0xcc,0x80,0x34,0xb0,0x09,0x3b,0x80,0x80,0x50,0xc0,0xf8,
+    0x30,0x31,0xe0,0x8b,0x28,0x07,0xc0,0x0c,0x12,0x04,0x8c,0x89,0x02,0x08,0x08,0xb4,
+    0x98,0x0f,0x34,0x00,0xbe,0x08,0x17,0xa0,0x9d,0x38,0x42,0xb9,0xb0,0x83,0x80,0x80,
+    0x70,0x8b,0xac,0x15,0x04,0xda,0x89,0x70,0x01,0xda,0x09,0x23,0xa3,0x0c,0x3e,0x80,
+    0x80,0x80,0xb4,0xd0,0x49,0x32,0xb0,0x9f,0x28,0x07,0xd0,0x0b,0x40,0x03,0x8c,0x98,
+    0x82,0x80,0x80,0x85,0x9b,0x1f,0x13,0x83,0xbf,0x80,0x73,0x80,0xbc,0x38,0x51,0xc0,
+    0xb0,0x21,0x88,0x00,0x48,0x8b,0xfa,0x31,0x05,0xd8,0x8a,0x78,0x02,0xda,0x89,0x33,
+    0xa3,0x0c,0x3b,0x80,0x80,0x18,0xb7,0xe8,0x48,0x30,0xb0,0x8e,0x08,0x17,0xa0,0x9e,
+    0x31,0x31,0xab,0xd9,0x04,0x08,0x08,0x10,0x8a,0x9f,0x25,0x01,0xeb,0x88,0x44,0x80,
+    0xad,0x18,0x53,0xc0,0x90,0x18,0x80,0x80,0x60,0x9a,0xd9,0x22,0x23,0xf9,0x0b,0x48,
+    0x05,0xd8,0x8a,0x04,0x84,0x8b,0x2b,0x01,0x08,0x08,0xc5,0xa0,0x2d,0x63,0x80,0xad,
+    0x88,0x27,0xb0,0x8d,0x48,0x12,0xaa,0xb0,0x03,0x08,0x08,0x72,0x8c,0x8d,0x04,0x03,
+    0xcc,0x88,0x70,0x01,0xdb,0x18,0x22,0xc3,0x99,0x4a,0x08,0x08,0x10,0xa0,0xf8,0x6a,
+    0x12,0xc0,0x8c,0x58,0x03,0xd9,0x8a,0x22,0x85,0x8b,0x19,0x00,0x08,0x08,0xa7,0xa9,
+    0x3b,0x44,0x91,0xaf,0x08,0x35,0x90,0xad,0x48,0x40,0xb8,0xc8,0x03,0x08,0x08,0x48,
+    0x0b,0xbc,0x34,0x06,0xd9,0x0a,0x70,0x01,0xeb,0x08,0x24,0xb1,0x09,0x3b,0x08,0x08,
+    0x48,0xf3,0xd8,0x30,0x41,0xc0,0x0c,0x38,0x06,0xc0,0x8b,0x22,0x23,0x9d,0x99,0x84,
+    0x80,0x80,0x92,0x89,0x9f,0x35,0x01,0xcd,0x80,0x26,0x90,0xad,0x28,0x43,0xc8,0xa0,
+    0x82,0x80,0x80,0x70,0x8b,0xba,0x24,0x14,0xea,0x0a,0x78,0x02,0xe9,0x89,0x04,0x94,
+    0x8a,0x3c,0x80,0x00,0x88,0xb4,0xd0,0x4a,0x33,0xb0,0xaf,0x10,0x07,0xc0,0x0c,0x48,
+    0x03,0x9b,0xb0,0x03,0x08,0x08,0x05,0x8c,0x0f,0x13,0x03,0xbe,0x88,0x35,0x00,0xbd,
+    0x38,0x41,0xc1,0xa8,0x20,0x08,0x08,0x58,0x8b,0xf8,0x30,0x04,0xd0,0x8b,0x70,0x01,
+    0xda,0x89,0x23,0x94,0x0b,0x3b,0x08,0x08,0x08,0xb7,0xc8,0x49,0x51,0xa0,0x9d,0x80,
+    0x17,0xa0,0x9d,0x21,0x31,0xb9,0xe8,0x03,0x08,0x08,0x38,0x8b,0x9f,0x24,0x02,0xeb,
+    0x09,0x62,0x08,0xac,0x18,0x42,0xb0,0x88,0x19,0x00,0x88,0x50,0xa9,0xf9,0x31,0x31,
+    0xf8,0x0a,0x68,0x00,0xb8,0x0b,0x03,0x05,0x0c,0x1a,0x00,0x08,0x80,0xb3,0xa8,0x1f,
+    0x63,0x88,0xcb,0x80,0x07,0x90,0x8b,0x38,0x31,0xaa,0xb8,0x03,0x08,0x08,0x70,0x8b,
+    0x9d,0x05,0x03,0xdb,0x88,0x70,0x00,0xaa,0x08,0x12,0xa2,0x8a,0x4b,0x80,0x80,0x00,
+    0xb2,0xf0,0x6a,0x11,0xb0,0x9c,0x40,0x03,0xd8,0x8a,0x31,0x84,0x8b,0x88,0x81,0x80,
+    0x80,0x96,0x9a,0x2c,0x33,0x92,0xbf,0x80,0x17,0x88,0xaa,0x38,0x40,0xb8,0xa8,0x02,
+    0x80,0x80,0x30,0x8b,0xfb,0x32,0x85,0xc8,0x8a,0x70,0x80,0xa9,0x08,0x12,0x91,0x89,
+    0x19,0x80,0x80,0x00,0xc3,0xc0,0x30,0x28,0x98,0x0a,0x00
+};
+const Sample honk PROGMEM = {honkData, 3125, 6, 37};
+
+// Array of samples to play from the menu.
+const Sample *const samples[] PROGMEM = {&honk};
+const uint8_t sampleCount = sizeof(samples) / sizeof(Sample*);
\ No newline at end of file
@@ -0,0 +1,129 @@
+/** boost.cpp
+ * See boost.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include "boost.h"
+#include "clock.h"
+
+uint8_t BoostManager::s_duty;
+volatile uint8_t BoostManager::s_target = 0;
+volatile uint16_t BoostManager::s_idleCountdown = 0;
+bool BoostManager::s_keepWarm = false;
+
+void BoostManager::start() {
+    uint8_t oldSREG = SREG;
+    cli();
+    s_idleCountdown = 0;
+    if (!isRunning()) {
+        ClockManager::fast(); // Timer 2 needs the full clock speed
+        PowerManager::acquire(POWER_TIMER2);
+        // Set PB3 to be an output (Pin11 Arduino UNO)
+        DDRB |= (1 << PB3);
+        s_duty = 0;
+        s_target = BOOST_PRECHARGE_DUTY;
+        OCR2A = 0;
+        TCCR2A = (1 << COM2A1) | (1 << WGM21) | (1 << WGM20); // Mode 3, fast PWM, reset at 255
+        TCCR2B = (1 << CS20); // Prescalar 1
+        TIMSK0 |= (1 << OCIE0A);
+        TRACE(TRACE_BOOST_START, BOOST_PRECHARGE_DUTY);
+    }
+    SREG = oldSREG;
+}
+
+void BoostManager::stop() {
+    uint8_t oldSREG = SREG;
+    cli();
+    m_stopTick();
+    if (isRunning()) {
+        TCCR2A = 0;
+        TCCR2B = 0;
+        PowerManager::release(POWER_TIMER2);
+    }
+    s_target = 0;
+    s_idleCountdown = 0;
+    SREG = oldSREG;
+    TRACE(TRACE_BOOST_STOP, 0);
+}
+
+void BoostManager::idle() {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (isRunning()) {
+        s_target = 0;
+        OCR2A = IDLE_DUTY; // Enough duty to keep the voltage up ready for the next note
+        if (!s_keepWarm) {
+            s_idleCountdown = BOOST_IDLE_TIMEOUT;
+            TIMSK0 |= (1 << OCIE0A);
+        }
+    }
+    SREG = oldSREG;
+}
+
+void BoostManager::wake() {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (isRunning()) {
+        s_idleCountdown = 0;
+    } else {
+        start();
+    }
+    SREG = oldSREG;
+}
+
+void BoostManager::setKeepWarm(bool keep) {
+    s_keepWarm = keep;
+    if (keep) {
+        wake();
+    } else if (isRunning() && !PowerManager::isOn(POWER_TIMER1)) {
+        idle(); // Start counting down to turning off
+    }
+}
+
+void BoostManager::tick() {
+    if (s_target) {
+        // Soft starting. If something else set the duty, ramp to that instead.
+        if (OCR2A != s_duty) {
+            s_target = OCR2A;
+        }
+        if (s_target - s_duty > BOOST_SOFT_START_STEP) {
+            s_duty += BOOST_SOFT_START_STEP;
+        } else {
+            // Finished. Count down to idle if nothing is playing yet.
+            s_duty = s_target;
+            s_target = 0;
+            if (!s_keepWarm && !PowerManager::isOn(POWER_TIMER1)) {
+                s_idleCountdown = BOOST_IDLE_TIMEOUT;
+            }
+        }
+        OCR2A = s_duty;
+    } else if (s_idleCountdown) {
+        s_idleCountdown--;
+        if (!PowerManager::isOn(POWER_TIMER1)) {
+            if (s_idleCountdown == 0) {
+                stop();
+                return;
+            } else if (s_idleCountdown == BOOST_IDLE_TIMEOUT - BOOST_PRECHARGE_TIME) {
+                OCR2A = IDLE_DUTY; // Precharged with nothing playing yet, don't hold the higher duty
+            }
+        }
+    }
+
+    if (!s_target && !s_idleCountdown) {
+        m_stopTick(); // Nothing to do until the next sound
+    }
+}
+
+#ifndef ENABLE_WATCHDOG_FORENSICS // Otherwise shared with the watchdog monitor in watchdog.cpp
+/**
+ * @brief Steps the boost soft start and idle timeout. Timer 0 is also used for
+ * millis(), so this happens once every 1.024ms.
+ * 
+ */
+ISR(TIMER0_COMPA_vect) {
+    BoostManager::tick();
+}
+#endif
\ No newline at end of file
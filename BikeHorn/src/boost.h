@@ -0,0 +1,120 @@
+/** boost.h
+ * Manages the intermediate boost stage (timer 2 on PB3, pin 11).
+ * 
+ * The boost is soft started as soon as the horn button wakes the horn up, so
+ * it is charged by the time the first note plays. Once nothing has played for
+ * BOOST_IDLE_TIMEOUT, it is turned off until the next sound instead of idling
+ * for the rest of the time the horn is awake (menus, alarm countdowns, ...).
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include <Arduino.h>
+#include "trace.h"
+#include "power.h"
+
+/**
+ * @brief Starts, ramps and stops the boost stage. Ramping and idle timeouts
+ * are handled from the timer 0 compare A interrupt once every 1.024ms.
+ * 
+ * Anything can set OCR2A directly while the boost is running. If this happens
+ * part way through a soft start, the new value becomes the duty to ramp to.
+ * 
+ */
+class BoostManager {
+    public:
+        /**
+         * @brief Starts the boost stage if it is not already running and
+         * ramps it up to BOOST_PRECHARGE_DUTY. If nothing has played
+         * BOOST_PRECHARGE_TIME after that, it drops to IDLE_DUTY. Safe to call
+         * from an interrupt.
+         * 
+         */
+        static void start();
+
+        /**
+         * @brief Turns the boost stage off immediately.
+         * 
+         */
+        static void stop();
+
+        /**
+         * @brief Sets the boost stage to IDLE_DUTY and starts counting down to
+         * turn it off. Call when a sound stops.
+         * 
+         */
+        static void idle();
+
+        /**
+         * @brief Makes sure the boost stage is running and cancels any idle
+         * timeout. Call before a sound starts.
+         * 
+         */
+        static void wake();
+
+        /**
+         * @brief Keeps the boost stage running at IDLE_DUTY instead of turning
+         * it off after BOOST_IDLE_TIMEOUT. Used to keep it warm while riding.
+         * 
+         * The boost stage must not be left running while powered down, as
+         * timer 2 could stop with the output high.
+         * 
+         * @param keep true to start it and keep it running, false to let it
+         *             time out again.
+         */
+        static void setKeepWarm(bool keep);
+
+        /**
+         * @brief Returns true if the boost stage is being kept warm.
+         * 
+         */
+        static inline bool isKeptWarm() {
+            return s_keepWarm;
+        }
+
+        /**
+         * @brief Returns true if the boost stage is part way through a soft
+         * start.
+         * 
+         */
+        static inline bool isSoftStarting() {
+            return s_target;
+        }
+
+        /**
+         * @brief Returns true if timer 2 is running.
+         * 
+         */
+        static inline bool isRunning() {
+            return PowerManager::isOn(POWER_TIMER2) && TCCR2B;
+        }
+
+        /**
+         * @brief Steps the soft start and idle timeout. Called from the timer 0
+         * compare A interrupt.
+         * 
+         */
+        static void tick();
+
+    private:
+        /**
+         * @brief Turns the timer 0 compare A interrupt off unless the watchdog
+         * monitor is using it.
+         * 
+         */
+        static inline void m_stopTick() {
+#ifdef ENABLE_WATCHDOG_FORENSICS
+            if (WatchdogMonitor::isEnabled()) {
+                return;
+            }
+#endif
+            TIMSK0 &= ~(1 << OCIE0A);
+        }
+
+        static uint8_t s_duty; // Duty the soft start is up to.
+        static volatile uint8_t s_target; // Duty the soft start is ramping to. 0 when not ramping.
+        static volatile uint16_t s_idleCountdown; // Ticks until turning off. 0 when not counting down.
+        static bool s_keepWarm;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+/** clock.cpp
+ * See clock.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include <Arduino.h>
+#include <avr/power.h>
+#include "clock.h"
+#include "power.h"
+
+#ifdef ENABLE_CLOCK_SCALING
+volatile bool ClockManager::s_slow = false;
+uint16_t ClockManager::s_baud;
+
+void ClockManager::slow() {
+    if (s_slow || PowerManager::isOn(POWER_TIMER1) || PowerManager::isOn(POWER_TIMER2)) {
+        return; // Already slow or timers 1 or 2 are in use.
+    }
+    bool serial = PowerManager::isOn(POWER_USART) && (UCSR0B & (bit(TXEN0) | bit(RXEN0)));
+    if (serial && (UBRR0 + 1) % CLOCK_SLOW_DIVISION) {
+        return; // Can't make this baud rate at the slower clock.
+    }
+    if (serial) {
+        Serial.flush(); // Don't change the baud rate part way through a byte.
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+    s_baud = UBRR0;
+    UBRR0 = (s_baud + 1) / CLOCK_SLOW_DIVISION - 1;
+    clock_prescale_set(clock_div_8);
+    TCCR0B = bit(CS01); // Timer 0 prescaler 8 (was 64)
+    if (PowerManager::isOn(POWER_ADC)) {
+        // Writes to ADCSRA are ignored while the ADC is off in PRR.
+        ADCSRA = (ADCSRA & ~ADC_PRESCALER_FAST) | ADC_PRESCALER_SLOW;
+    }
+    s_slow = true;
+    SREG = oldSREG;
+}
+
+void ClockManager::fast() {
+    if (!s_slow) {
+        return;
+    }
+    if (PowerManager::isOn(POWER_USART) && (UCSR0B & bit(TXEN0))) {
+        Serial.flush();
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+    clock_prescale_set(clock_div_1);
+    TCCR0B = bit(CS01) | bit(CS00); // Timer 0 prescaler 64
+    if (PowerManager::isOn(POWER_ADC)) {
+        ADCSRA = (ADCSRA & ~ADC_PRESCALER_FAST) | ADC_PRESCALER_FAST;
+    }
+    UBRR0 = s_baud;
+    s_slow = false;
+    SREG = oldSREG;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+/** clock.h
+ * Slows the CPU clock down while the horn is only waiting for buttons or the
+ * accelerometer, and speeds it back up before anything needs the timers.
+ * 
+ * Enable with ENABLE_CLOCK_SCALING in defines.h. When disabled, slow() and
+ * fast() do nothing.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "../defines.h"
+
+// Only 8 can be compensated for exactly by changing timer 0's prescaler (64 to 8).
+#define CLOCK_SLOW_DIVISION 8
+
+// ADC prescalers that keep the ADC clock at 125kHz (the datasheet wants 50 to
+// 200kHz for 10 bit results).
+#define ADC_PRESCALER_FAST (bit(ADPS2) | bit(ADPS1) | bit(ADPS0)) // 16MHz / 128
+#define ADC_PRESCALER_SLOW bit(ADPS2) // 2MHz / 16
+
+#ifdef ENABLE_CLOCK_SCALING
+/**
+ * @brief Switches the system clock between full speed and F_CPU /
+ * CLOCK_SLOW_DIVISION.
+ * 
+ * Timer 0's prescaler is changed at the same time so that it still ticks every
+ * 4us. millis(), micros(), delay() and everything that uses them
+ * (DEBOUNCE_TIME, LONG_PRESS_TIME, tunes, the timer 0 compare interrupts) are
+ * unaffected. The UART baud rate and ADC clock (if the ADC is powered) are
+ * also adjusted. Anything that turns the ADC on should use adcPrescaler().
+ * 
+ * Timers 1 and 2 can't be compensated for (the boost stage can't run any
+ * slower), so the clock is only slowed while both are switched off (see
+ * PowerManager). Anything that
+ * starts the boost (BoostManager::start()) speeds the clock up first.
+ * delayMicroseconds() is not compensated.
+ * 
+ */
+class ClockManager {
+    public:
+        /**
+         * @brief Slows the clock down if nothing needs it to be fast. Cheap to
+         * call often from loops that are waiting for something.
+         * 
+         * The clock is left at full speed if serial is running at a baud rate
+         * that can't be generated at the slower clock (see defines.h).
+         * 
+         */
+        static void slow();
+
+        /**
+         * @brief Puts the clock back to full speed. Safe to call from an
+         * interrupt. Call before Serial.begin() as it calculates the baud rate
+         * from F_CPU.
+         * 
+         */
+        static void fast();
+
+        /**
+         * @brief Returns true if the clock is slowed down.
+         * 
+         */
+        static inline bool isSlow() {
+            return s_slow;
+        }
+
+        /**
+         * @brief Returns the ADPS bits to put in ADCSRA for the current clock
+         * speed.
+         * 
+         */
+        static inline uint8_t adcPrescaler() {
+            return s_slow ? ADC_PRESCALER_SLOW : ADC_PRESCALER_FAST;
+        }
+
+    private:
+        static volatile bool s_slow;
+        static uint16_t s_baud; // UBRR0 at full speed.
+};
+#else
+class ClockManager {
+    public:
+        static inline void slow() {}
+        static inline void fast() {}
+        static inline bool isSlow() {
+            return false;
+        }
+        static inline uint8_t adcPrescaler() {
+            return ADC_PRESCALER_FAST;
+        }
+};
+#endif
\ No newline at end of file
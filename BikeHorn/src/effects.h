@@ -0,0 +1,135 @@
+/** effects.h
+ * Vibrato, tremolo and arpeggio effects for notes. The effects are stepped from
+ * the timer 0 compare B interrupt, so they keep time regardless of what the
+ * main loop is doing.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+
+#define EFFECT_NONE 0
+#define EFFECT_VIBRATO 1 // Frequency follows a sine wave. depth is the cents either side.
+#define EFFECT_TREMOLO 2 // Piezo duty follows a sine wave. depth is the % to reduce the duty by at the quietest point (up to 100).
+#define EFFECT_ARPEGGIO 3 // Cycles through notes above the base note. depth is the number of notes.
+
+#define EFFECT_STEPS 16 // Steps in a vibrato or tremolo cycle (the size of effectSine).
+#define EFFECT_ARPEGGIO_NOTES 4 // Most notes in an arpeggio.
+
+/**
+ * @brief Settings for an effect. Stored in PROGMEM.
+ * 
+ */
+struct Effect {
+    uint8_t type; // EFFECT_...
+    uint8_t ticks; // Timer 0 overflows (1.024ms each) per step.
+    uint8_t depth; // See EFFECT_...
+    uint8_t notes[EFFECT_ARPEGGIO_NOTES]; // Semitones above the base note for each arpeggio step (up to 23).
+};
+
+// Helpers for filling in effect tables.
+#define NO_EFFECT {EFFECT_NONE, 0, 0, {0}}
+#define VIBRATO(TICKS, CENTS) {EFFECT_VIBRATO, TICKS, CENTS, {0}}
+#define TREMOLO(TICKS, PERCENT) {EFFECT_TREMOLO, TICKS, PERCENT, {0}}
+#define ARPEGGIO(TICKS, COUNT, ...) {EFFECT_ARPEGGIO, TICKS, COUNT, {__VA_ARGS__}} // COUNT is the number of notes given.
+
+/**
+ * @brief Precomputed timer settings for one step of an effect.
+ * 
+ */
+struct EffectStep {
+    uint16_t top; // ICR1
+    uint16_t compare; // OCR1A
+    uint8_t boost; // OCR2A
+};
+
+// One cycle of a sine wave, scaled to +-127.
+const int8_t effectSine[EFFECT_STEPS] PROGMEM = {0, 49, 90, 117, 127, 117, 90, 49, 0, -49, -90, -117, -127, -117, -90, -49};
+
+// Timer 1 top multipliers for 1 to 11 semitones up (2^(-n/12) * 65536).
+const uint16_t semitoneRatios[] PROGMEM = {61858, 58386, 55109, 52016, 49097, 46341, 43740, 41285, 38968, 36781, 34716};
+
+/**
+ * @brief Steps through a table of timer settings from the timer 0 compare B
+ * interrupt.
+ * 
+ * The table is filled in by BikeHornSound when a note starts (the EEPROM
+ * piecewise functions are too slow to run from an interrupt). Each step is
+ * handed to the timer 1 overflow interrupt through BikeHornSound::nextTop and
+ * nextComp so that it is applied at the start of a cycle.
+ * 
+ */
+class EffectEngine {
+    public:
+        /**
+         * @brief Starts stepping through the table.
+         * 
+         * @param length the number of steps in the table.
+         * @param ticks the number of timer 0 overflows per step.
+         */
+        static void start(uint8_t length, uint8_t ticks) {
+            if (length < 2 || ticks == 0) {
+                return; // Nothing to do.
+            }
+            s_length = length;
+            s_ticks = ticks;
+            s_countdown = ticks;
+            s_index = 0;
+            TIFR0 = bit(OCF0B); // Clear any old compare match
+            TIMSK0 |= bit(OCIE0B);
+        }
+
+        /**
+         * @brief Stops stepping through the table. The current step is left
+         * playing.
+         * 
+         */
+        static inline void stop() {
+            TIMSK0 &= ~bit(OCIE0B);
+        }
+
+        /**
+         * @brief Moves to the next step when it is time. Called from the timer
+         * 0 compare B interrupt.
+         * 
+         */
+        static void update();
+
+        /**
+         * @brief Returns the value of the sine wave for a step.
+         * 
+         * @param step the step (0 to EFFECT_STEPS - 1).
+         * @return int8_t the value (-127 to 127).
+         */
+        static inline int8_t sine(uint8_t step) {
+            return pgm_read_byte(&effectSine[step]);
+        }
+
+        /**
+         * @brief Returns the timer 1 top for a note a number of semitones above
+         * a given top.
+         * 
+         * @param top the timer 1 top of the base note.
+         * @param semitones the number of semitones up (0 to 23).
+         * @return uint16_t the new top.
+         */
+        static uint16_t transpose(uint16_t top, uint8_t semitones) {
+            if (semitones >= 12) {
+                top >>= 1;
+                semitones -= 12;
+            }
+            if (semitones == 0) {
+                return top;
+            }
+            return ((uint32_t)top * pgm_read_word(&semitoneRatios[semitones - 1])) >> 16;
+        }
+
+        static EffectStep table[EFFECT_STEPS];
+
+    private:
+        static uint8_t s_length;
+        static uint8_t s_ticks;
+        static uint8_t s_countdown;
+        static uint8_t s_index;
+};
\ No newline at end of file
@@ -2,11 +2,14 @@
  * Code for using the accelerometer
  * 
  * Written by Jotham Gates
- * Last modified 22/12/2022
+ * Last modified 18/10/2026
  */
 
 #pragma once
 #include "statistics.h"
+#include "../../power.h"
+// ClockManager comes from clock.h, included by burglerAlarm.h (not here so that
+// Tools/AlarmReplay can build this against its stub/clock.h instead).
 
 // #define ACCELEROMETER_ABS_CHANGE // If defined, store and process the absolute value, otherwise the raw change that may include negatives as well
 // #define ACCEL_DEBUG
@@ -14,6 +17,21 @@
 /**
  * @brief Class for handling an accelerometer axis.
  * 
+ * Readings are checked in two stages to keep the time spent awake short:
+ * 1. The change is compared against a cached band of whole numbers that are
+ *    definitely quiet (within NEAR_STD_DEVIATIONS of the mean). Almost every
+ *    reading stops here.
+ * 2. Anything outside the band is tested properly against the cached mean and
+ *    standard deviation.
+ * 
+ * The statistics (and the cached mean, standard deviation and band) are only
+ * updated every ACCEL_CASCADE_REFRESH samples regardless of which stage the
+ * sample stopped at so that the noise estimate is not biased towards the
+ * larger changes.
+ * 
+ * With ACCEL_EWMA_CUSUM defined, EwmaCusum is used instead. It is cheap
+ * enough to test and update every reading, so the stages are skipped.
+ * 
  */
 class AccelerometerAxis {
     public:
@@ -32,17 +50,32 @@ class AccelerometerAxis {
          */
         void calibrate() {
             int16_t current = analogRead(m_channel);
-            int16_t diff = current - m_previous;
+            if (m_hasPrevious) {
+                // The first reading has nothing to compare against.
+                int16_t diff = current - m_previous;
 #ifdef ACCELEROMETER_ABS_CHANGE
-            m_stats.add(abs(diff));
-#else
-            m_stats.add(diff);
+                diff = abs(diff);
+#endif
+                m_stats.add(diff);
+#ifndef ACCEL_EWMA_CUSUM
+                m_refresh();
 #endif
+            }
             m_previous = current;
+            m_hasPrevious = true;
+        }
+
+        /**
+         * @brief Reads the axis without processing the result.
+         * 
+         * @return int16_t the raw ADC reading.
+         */
+        inline int16_t read() const {
+            return analogRead(m_channel);
         }
 
         /**
-         * @brief Measures the accelerometer axis, calculates averages and standard deviation.
+         * @brief Measures the accelerometer axis and checks if it has moved.
          * 
          * @return true if this is extremely unlikely that the value detected was due to noise (moved).
          * @return false if it was more likely that the value detected was due to noise (not moved).
@@ -51,15 +84,8 @@ class AccelerometerAxis {
             // Adc parts from https://www.gammon.com.au/adc
             ADMUX = bit(REFS0) | ((m_channel-A0) & 0x07);  // AVcc, set the mux
             bitSet(ADCSRA, ADSC);  // Start a conversion
-
-            // Time consuming operations
-            double mean = m_stats.standardDev.mean();
-            double std = m_stats.standardDev.std();
-#ifdef ACCEL_DEBUG
-            Serial.print(mean);
-            Serial.write(' ');
-            Serial.print(std);
-            Serial.write(' ');
+#ifndef ACCEL_EWMA_CUSUM
+            bool refresh = ++m_samplesSinceRefresh >= ACCEL_CASCADE_REFRESH;
 #endif
 
             // Wait until the ADC conversion is finished
@@ -67,31 +93,132 @@ class AccelerometerAxis {
                 // Can often be somewhere in the range of 0 to 50 iterations with incrementing int count
             }
 
-            // Run the analysis
             int16_t current = ADC;
             int16_t change = current-m_previous;
+            m_previous = current;
 #ifdef ACCELEROMETER_ABS_CHANGE
             change = abs(change);
 #endif
+            m_recent.push(change);
 #ifdef ACCEL_DEBUG
+            Serial.print(mean());
+            Serial.write(' ');
+            Serial.print(std());
+            Serial.write(' ');
             Serial.print(current);
             Serial.write(' ');
             Serial.print(change);
             Serial.write(' ');
 #endif
-            bool result = m_stats.isUnlikely(change, mean, max(std, 1));
+
+#ifdef ACCEL_EWMA_CUSUM
+            bool result = m_stats.isUnlikely(change);
+            m_nearThreshold = m_stats.isNear();
+            return result;
+#else
+            // Stage 1: Nothing happened.
+            if (!refresh && change >= m_quietLow && change <= m_quietHigh) {
+                m_nearThreshold = false;
+                return false;
+            }
+
+            // Stage 2: Run the full analysis.
+            bool result = m_stats.isUnlikely(change, m_mean, m_std);
+            m_nearThreshold = m_stats.isOutside(change, m_mean, m_std, NEAR_STD_DEVIATIONS);
 
             // Add the results to the sample set.
-            m_stats.update(change);
-            m_previous = current;
+            if (refresh) {
+                m_stats.update(change);
+                m_refresh();
+            }
 
             return result;
+#endif
+        }
+
+        /**
+         * @brief Returns whether the last reading from isMoved() was close to
+         * (or over) the threshold for being moved.
+         * 
+         * @return true if the last reading was more than NEAR_STD_DEVIATIONS
+         *         from the mean.
+         */
+        inline bool isNearThreshold() const {
+            return m_nearThreshold;
+        }
+
+        /**
+         * @brief Returns the last few changes measured by isMoved().
+         * 
+         * @return const RingBuffer<int16_t, ALARM_LOG_CHANGES>& 
+         */
+        inline const RingBuffer<int16_t, ALARM_LOG_CHANGES>& recentChanges() const {
+            return m_recent;
+        }
+
+        /**
+         * @brief Returns the mean used to test the last reading.
+         * 
+         * @return double 
+         */
+        inline double mean() const {
+#ifdef ACCEL_EWMA_CUSUM
+            return m_stats.mean();
+#else
+            return m_mean;
+#endif
+        }
+
+        /**
+         * @brief Returns the standard deviation used to test the last reading.
+         * 
+         * @return double 
+         */
+        inline double std() const {
+#ifdef ACCEL_EWMA_CUSUM
+            return m_stats.std();
+#else
+            return m_std;
+#endif
         }
 
     private:
+#ifndef ACCEL_EWMA_CUSUM
+        /**
+         * @brief Recalculates the mean, standard deviation and band of quiet
+         * readings from the statistics (time consuming).
+         * 
+         */
+        void m_refresh() {
+            m_samplesSinceRefresh = 0;
+            m_mean = m_stats.standardDev.mean();
+            double std = m_stats.standardDev.std();
+            m_std = max(std, 1);
+            double halfWidth = NEAR_STD_DEVIATIONS * m_std;
+            m_quietLow = ceil(m_mean - halfWidth);
+            m_quietHigh = floor(m_mean + halfWidth);
+        }
+#endif
+
         const uint8_t m_channel;
-        NullHypothesis<double> m_stats;
+#ifdef ACCEL_EWMA_CUSUM
+        EwmaCusum m_stats;
+#else
+        NullHypothesis<double, int16_t> m_stats; // Changes between readings are always whole numbers.
+#endif
         int16_t m_previous;
+        bool m_hasPrevious = false;
+        bool m_nearThreshold = false;
+        RingBuffer<int16_t, ALARM_LOG_CHANGES> m_recent; // Kept for the trigger log.
+
+#ifndef ACCEL_EWMA_CUSUM
+        // Cached results of the statistics.
+        double m_mean;
+        double m_std;
+        int16_t m_quietLow = 1; // Empty band until calibrated.
+        int16_t m_quietHigh = 0;
+        uint8_t m_samplesSinceRefresh = 0;
+#endif
 };
 
 /**
@@ -109,29 +236,43 @@ class Acceleromenter {
             digitalWrite(ACCEL_POWER_PIN, HIGH);
         }
 
+        /**
+         * @brief Returns true if the accelerometer is turned on.
+         * 
+         */
+        inline bool isPowered() const {
+            return *portModeRegister(digitalPinToPort(ACCEL_POWER_PIN)) & digitalPinToBitMask(ACCEL_POWER_PIN);
+        }
+
         /**
          * @brief Turns the accelerometer off.
          * 
          */
-        inline void stop() const {
+        inline void stop() {
             pinMode(ACCEL_POWER_PIN, INPUT);
-            ADCSRA = 0; // Switch of the ADC
+            if (m_adcOn) {
+                PowerManager::release(POWER_ADC); // Switches off the ADC if nothing else is using it
+                m_adcOn = false;
+            }
         }
 
         /**
          * @brief Turns on the ADC
          * 
          */
-        inline void startADC() const {
-            ADCSRA =  bit (ADEN);   // turn ADC on
-            ADCSRA |= bit (ADPS0) |  bit (ADPS1) | bit (ADPS2);  // Prescaler of 128
+        inline void startADC() {
+            if (!m_adcOn) {
+                PowerManager::acquire(POWER_ADC);
+                m_adcOn = true;
+            }
+            ADCSRA = bit(ADEN) | ClockManager::adcPrescaler(); // turn ADC on
         }
 
         /**
          * @brief Turns the accelerometer and ADC on
          * 
          */
-        inline void start() const {
+        inline void start() {
             powerOn();
             startADC();
         }
@@ -157,6 +298,7 @@ class Acceleromenter {
             bool x = m_xAxis.isMoved();
             bool y = m_yAxis.isMoved();
             bool z = m_zAxis.isMoved();
+            m_movedAxes = x | y << 1 | z << 2;
             bool result = x || y || z;
 #ifdef ACCEL_DEBUG
             Serial.println(result);
@@ -164,8 +306,40 @@ class Acceleromenter {
             return result;
         }
 
+        /**
+         * @brief Checks whether any axis was close to the threshold on the
+         * last call to isMoved().
+         * 
+         * @return true if at least one axis was close.
+         * @return false if all axes were quiet.
+         */
+        inline bool isNearThreshold() const {
+            return m_xAxis.isNearThreshold() || m_yAxis.isNearThreshold() || m_zAxis.isNearThreshold();
+        }
+
+        /**
+         * @brief Returns which axes were moved on the last call to isMoved().
+         * 
+         * @return uint8_t bit 0 is x, bit 1 is y and bit 2 is z.
+         */
+        inline uint8_t movedAxes() const {
+            return m_movedAxes;
+        }
+
+        /**
+         * @brief Returns an axis.
+         * 
+         * @param index 0 for x, 1 for y, 2 for z.
+         * @return const AccelerometerAxis& 
+         */
+        inline const AccelerometerAxis& axis(uint8_t index) const {
+            return index == 0 ? m_xAxis : (index == 1 ? m_yAxis : m_zAxis);
+        }
+
     private:
         AccelerometerAxis m_xAxis = AccelerometerAxis(ACCEL_X_PIN);
         AccelerometerAxis m_yAxis = AccelerometerAxis(ACCEL_Y_PIN);
         AccelerometerAxis m_zAxis = AccelerometerAxis(ACCEL_Z_PIN);
+        bool m_adcOn = false; // True if this is one of the users of the ADC.
+        uint8_t m_movedAxes = 0;
 };
\ No newline at end of file
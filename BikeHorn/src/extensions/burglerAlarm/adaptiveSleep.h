@@ -0,0 +1,80 @@
+/** adaptiveSleep.h
+ * Works out how long the burgler alarm should sleep between accelerometer
+ * samples in the sleep state.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#pragma once
+
+/**
+ * @brief Class for adapting the time between samples to the recent noise.
+ * 
+ * Starts at the shortest period. Each time enough quiet samples are taken in a
+ * row, the period is doubled (the next LowPower period) until the longest is
+ * reached. A reading that is close to the detection threshold drops the period
+ * straight back to the shortest so that any further movement is picked up
+ * quickly.
+ * 
+ */
+class AdaptiveSleep {
+    public:
+        /**
+         * @brief Construct a new Adaptive Sleep object.
+         * 
+         * @param minPeriod the shortest (and starting) period to sleep for.
+         * @param maxPeriod the longest period to sleep for.
+         * @param quietSamples the number of quiet samples in a row required
+         *                     before the period is lengthened.
+         */
+        AdaptiveSleep(const period_t minPeriod, const period_t maxPeriod, const uint8_t quietSamples) :
+            m_minPeriod(minPeriod), m_maxPeriod(maxPeriod), m_quietSamples(quietSamples) {
+            reset();
+        }
+
+        /**
+         * @brief Goes back to the shortest period.
+         * 
+         */
+        void reset() {
+            m_period = m_minPeriod;
+            m_quietCount = 0;
+        }
+
+        /**
+         * @brief Returns the period to sleep for before the next sample.
+         * 
+         * @return period_t
+         */
+        inline period_t period() const {
+            return m_period;
+        }
+
+        /**
+         * @brief Updates the period based on the latest sample.
+         * 
+         * @param nearThreshold true if the sample was close to (or over) the
+         *                      detection threshold.
+         */
+        void update(bool nearThreshold) {
+            if (nearThreshold) {
+                // Something might be happening, sample quickly again.
+                reset();
+            } else if (++m_quietCount >= m_quietSamples) {
+                // Quiet for a while, back off.
+                m_quietCount = 0;
+                if (m_period < m_maxPeriod) {
+                    m_period = (period_t)(m_period + 1);
+                }
+            }
+        }
+
+    private:
+        const period_t m_minPeriod;
+        const period_t m_maxPeriod;
+        const uint8_t m_quietSamples;
+        period_t m_period;
+        uint8_t m_quietCount;
+};
\ No newline at end of file
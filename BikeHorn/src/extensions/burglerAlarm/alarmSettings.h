@@ -0,0 +1,95 @@
+/** alarmSettings.h
+ * Settings for tuning the burgler alarm's movement detection. These are kept
+ * separate so that they can be used by the replay tool in Tools/AlarmReplay.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+
+// Each setting can be overridden with a compiler flag when testing with the
+// replay tool.
+#ifndef PREVIOUS_RECORDS
+#define PREVIOUS_RECORDS 32 // Must be a power of 2 (ring buffer size).
+#endif
+#ifndef STD_DEVIATIONS
+#define STD_DEVIATIONS 3
+#endif
+#ifndef IGNORE_CYCLES
+#define IGNORE_CYCLES 20
+#endif
+#ifndef ALERT_CYCLES
+#define ALERT_CYCLES 40
+#endif
+#ifndef NEAR_STD_DEVIATIONS
+#define NEAR_STD_DEVIATIONS 2 // Readings further than this from the mean stop the sleep state backing off.
+#endif
+#ifndef SLEEP_PERIOD_MIN
+#define SLEEP_PERIOD_MIN SLEEP_1S // Shortest (and starting) time between samples in the sleep state.
+#endif
+#ifndef SLEEP_PERIOD_MAX
+#define SLEEP_PERIOD_MAX SLEEP_4S // Longest time between samples in the sleep state once it has been quiet.
+#endif
+#ifndef SLEEP_QUIET_SAMPLES
+#define SLEEP_QUIET_SAMPLES 30 // Quiet samples in a row needed before moving to the next longest period.
+#endif
+// #define ACCEL_EWMA_CUSUM // If defined, detect movement with EwmaCusum instead of NullHypothesis (see statistics.h).
+#ifndef EWMA_SHIFT
+#define EWMA_SHIFT 5 // The mean and variance move 1/2^EWMA_SHIFT of the way to each new value (EwmaCusum only). Max 7.
+#endif
+#ifndef EWMA_CLAMP
+#define EWMA_CLAMP 127 // Deviations from the mean are clamped to this many ADC counts so their squares fit in 32 bits (EwmaCusum only).
+#endif
+#ifndef CUSUM_SLACK
+#define CUSUM_SLACK 2 // Deviations smaller than this many 1/8 standard deviations don't add to the CUSUM (EwmaCusum only).
+#endif
+#ifndef CUSUM_LIMIT
+#define CUSUM_LIMIT 4 // Standard deviations the CUSUM has to reach to count as moved (EwmaCusum only).
+#endif
+#ifndef ACCEL_CASCADE_REFRESH
+#define ACCEL_CASCADE_REFRESH 4 // Update the statistics and quiet band every this many samples. 1 updates on every sample.
+#endif
+#ifndef ACCEL_SETTLE_MAX
+#define ACCEL_SETTLE_MAX SLEEP_250MS // Time to wait after turning the accelerometer on if it hasn't been calibrated (also the longest allowed).
+#endif
+#ifndef ACCEL_SETTLE_TRIALS
+#define ACCEL_SETTLE_TRIALS 5 // Number of times to power up the accelerometer when measuring the settle time. The longest is used.
+#endif
+#ifndef ACCEL_SETTLE_TOLERANCE
+#define ACCEL_SETTLE_TOLERANCE 3 // ADC counts from the settled reading that count as settled.
+#endif
+#ifndef ACCEL_SETTLE_WINDOW
+#define ACCEL_SETTLE_WINDOW 400 // ms to watch the accelerometer for after turning it on.
+#endif
+#ifndef ACCEL_SETTLE_MARGIN
+#define ACCEL_SETTLE_MARGIN 50 // % to add to the measured settle time to allow for the watchdog running fast.
+#endif
+#ifndef ALARM_LOG_CHANGES
+#define ALARM_LOG_CHANGES 4 // Number of changes per axis to save in the trigger log. Must be a power of 2.
+#endif
+
+// Rough current model in uA for estimating the charge used by each state. The
+// datasheet figures are for a 5V ATmega328P. Measure the actual horn for
+// better estimates.
+#ifndef CURRENT_ACTIVE
+#define CURRENT_ACTIVE 10000 // Microcontroller running at 16MHz.
+#endif
+#ifndef CURRENT_ACTIVE_SLOW
+#define CURRENT_ACTIVE_SLOW 1500 // Microcontroller slowed to 2MHz by ClockManager.
+#endif
+#ifndef CURRENT_POWER_DOWN
+#define CURRENT_POWER_DOWN 6 // Power down mode with the watchdog running and BOD off.
+#endif
+#ifndef CURRENT_ADC
+#define CURRENT_ADC 250 // Extra while the ADC is enabled.
+#endif
+#ifndef CURRENT_ACCELEROMETER
+#define CURRENT_ACCELEROMETER 350 // Extra while the accelerometer is powered.
+#endif
+#ifndef CURRENT_BOOST
+#define CURRENT_BOOST 3000 // Extra while the boost stage is running.
+#endif
+#ifndef CURRENT_SOUND
+#define CURRENT_SOUND 30000 // Extra while a tune is playing.
+#endif
\ No newline at end of file
@@ -5,7 +5,7 @@
  * movement is detected.
  * 
  * Written by Jotham Gates
- * Last modified 27/01/2023
+ * Last modified 18/10/2026
  */
 
 #include "burglerAlarm.h"
@@ -27,15 +27,35 @@ extern void wakeUpDisable();
 StatesList State::states;
 CodeEntry* State::codeEntry;
 Acceleromenter* State::accelerometer;
+TriggerLog* State::triggerLog;
+uint32_t State::m_armedMillis;
+uint32_t State::m_sleptTime;
+
+// Nominal watchdog periods for each period_t in ms.
+const uint16_t sleepPeriods[] PROGMEM = {15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000};
 
 BurglerAlarmExtension::BurglerAlarmExtension() {
     // Add the burgler alarm function pointer to the menu
-    menuActions.length = 1;
-    menuActions.array = (MenuItem*)malloc(sizeof(MenuItem));
+    menuActions.length = 4;
+    menuActions.array = (MenuItem*)malloc(4*sizeof(MenuItem));
     menuActions.array[0] = (MenuItem)&BurglerAlarmExtension::stateMachine;
+    menuActions.array[1] = (MenuItem)&BurglerAlarmExtension::dumpLog;
+    menuActions.array[2] = (MenuItem)&BurglerAlarmExtension::printStats;
+    menuActions.array[3] = (MenuItem)&BurglerAlarmExtension::calibrateSettle;
 }
 
 void BurglerAlarmExtension::onStart() {
+    if (m_used) {
+        // Probably reset while riding (brown out), so don't arm.
+        Serial.println(F("Horn used since starting, not arming"));
+        return;
+    }
+    if (WatchdogMonitor::resetCause() & (bit(BORF) | bit(WDRF))) {
+        // Reset by a brown out or the watchdog, which could be mid ride before the horn has been pressed. Arming
+        // would tie the horn up calibrating for several seconds.
+        Serial.println(F("Reset by brown out or watchdog, not arming"));
+        return;
+    }
     stateMachine();
 }
 
@@ -65,28 +85,133 @@ void BurglerAlarmExtension::stateMachine() {
     Acceleromenter accelerometer;
     State::accelerometer = &accelerometer;
 
+    // Add the log of what set the alarm off
+    TriggerLog triggerLog;
+    State::triggerLog = &triggerLog;
+
     // Run the state machine
+    StateStats::begin();
     State* current = &init;
     while (current) {
         wakeGPIO(); // To enable serial
-        Serial.println(current->name); // NOTE: For debugging
+        Serial.println(StateStats::name(current->id)); // NOTE: For debugging
+        StateStats::enter(current->id);
+        TRACE(TRACE_STATE, current->id);
         current = current->enter();
+        StateStats::awake(accelerometer.isPowered());
     }
 
     // Tidy up
     accelerometer.stop();
+    triggerLog.flush();
     Serial.println(F("Exiting burgler alarm"));
+    StateStats::print();
     // TODO: Beep?
 
 }
 
+void BurglerAlarmExtension::dumpLog() {
+    TriggerLog::dump();
+}
+
+void BurglerAlarmExtension::printStats() {
+    StateStats::print();
+}
+
+void BurglerAlarmExtension::calibrateSettle() {
+    Serial.println(F("Measuring accelerometer settle time. Keep still"));
+    Acceleromenter accelerometer;
+    uint16_t longest = 0;
+    for (uint8_t i = 0; i < ACCEL_SETTLE_TRIALS; i++) {
+        uint16_t time = m_measureSettle(accelerometer);
+        Serial.print(F("Settled after (ms): "));
+        Serial.println(time);
+        if (time > longest) {
+            longest = time;
+        }
+    }
+    accelerometer.stop();
+
+    // Find the shortest watchdog period that is long enough.
+    uint16_t required = longest + (uint32_t)longest * ACCEL_SETTLE_MARGIN / 100;
+    uint8_t period = SLEEP_15MS;
+    while (period < ACCEL_SETTLE_MAX && pgm_read_word(&sleepPeriods[period]) < required) {
+        period++;
+    }
+    Serial.print(F("Using (ms): "));
+    Serial.println(pgm_read_word(&sleepPeriods[period]));
+    if (pgm_read_word(&sleepPeriods[period]) < required) {
+        Serial.println(F("Settle time is longer than ACCEL_SETTLE_MAX"));
+    }
+    StateSleep::saveSettlePeriod((period_t)period);
+    uiBeepBlocking(const_cast<uint16_t*>(beeps::acknowledge));
+}
+
+uint16_t BurglerAlarmExtension::m_measureSettle(Acceleromenter& accelerometer) {
+    // Get the settled readings.
+    accelerometer.start();
+    delay(ACCEL_SETTLE_WINDOW);
+    int16_t settled[3];
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        int32_t total = 0;
+        for (uint8_t i = 0; i < 16; i++) {
+            total += accelerometer.axis(axis).read();
+        }
+        settled[axis] = total / 16;
+    }
+
+    // Turn off for long enough to discharge.
+    accelerometer.stop();
+    WATCHDOG_RESET;
+    delay(1000);
+    WATCHDOG_RESET;
+
+    // Turn on and watch for the last time a reading was outside tolerance.
+    accelerometer.start();
+    uint32_t start = micros();
+    uint32_t lastUnsettled = 0;
+    uint32_t elapsed;
+    do {
+        elapsed = micros() - start;
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            int16_t difference = accelerometer.axis(axis).read() - settled[axis];
+            if (abs(difference) > ACCEL_SETTLE_TOLERANCE) {
+                lastUnsettled = elapsed;
+            }
+        }
+    } while (elapsed < (uint32_t)ACCEL_SETTLE_WINDOW * 1000);
+    WATCHDOG_RESET;
+    return (lastUnsettled + 999) / 1000;
+}
+
+void State::arm() {
+    m_armedMillis = millis();
+    m_sleptTime = 0;
+}
+
+uint32_t State::armedTime() {
+    // millis() doesn't increase while asleep.
+    return m_sleptTime + millis() - m_armedMillis;
+}
+
+void State::sleep(period_t period, adc_t adc) {
+    bool accelerometerOn = accelerometer->isPowered();
+    StateStats::awake(accelerometerOn);
+    LowPower.powerDown(period, adc, BOD_OFF);
+    if (period < SLEEP_FOREVER) {
+        uint16_t time = pgm_read_word(&sleepPeriods[period]);
+        m_sleptTime += time;
+        StateStats::asleep(time, adc == ADC_ON, accelerometerOn);
+    }
+}
+
 State* StateInit::enter() {
     // TODO: Button to cancel
     wakeUpEnable(); // Enable waking up and cancelling if pressed.
     accelerometer->start();
     for (uint8_t i = 0; i != PREVIOUS_RECORDS && wakePin == PRESSED_NONE; i++) {
         WATCHDOG_RESET;
-        LowPower.powerDown(SLEEP_250MS, ADC_ON, BOD_OFF); // Also time for startup
+        sleep(SLEEP_250MS, ADC_ON); // Also time for startup
         accelerometer->calibrate();
     }
     wakeUpDisable();
@@ -95,6 +220,7 @@ State* StateInit::enter() {
     if(wakePin == PRESSED_NONE) {
         // Not touched, go to alarm
         uiBeepBlocking(const_cast<uint16_t*>(beeps::acknowledge));
+        arm();
         return states.sleep;
     } else {
         // Touched, cancel alarm
@@ -106,15 +232,18 @@ State* StateInit::enter() {
 State* StateSleep::enter() {
     // State setup
     sleepGPIO();
+    ClockManager::slow(); // Serial and the boost are off, so nothing needs full speed.
     wakeUpEnable();
+    m_scheduler.reset();
+    bool moved = false;
 
     // Main loop
     do {
         WATCHDOG_RESET;
 
-        // Shut down and sleep
+        // Shut down and sleep for however long the recent readings allow
         accelerometer->stop();
-        LowPower.powerDown(SLEEP_1S, ADC_OFF, BOD_OFF);
+        sleep(m_scheduler.period(), ADC_OFF);
 
         // Check the button wasn't pressed during the shutdown sleep
         if (wakePin != PRESSED_NONE) {
@@ -123,11 +252,13 @@ State* StateSleep::enter() {
 
         // Turn the accelerometer on and wait for it start up
         accelerometer->powerOn();
-        LowPower.powerDown(SLEEP_250MS, ADC_OFF, BOD_OFF);
+        sleep(m_settlePeriod, ADC_OFF);
 
         // Take the reading
         accelerometer->startADC();
-    } while (wakePin == PRESSED_NONE && !accelerometer->isMoved());
+        moved = accelerometer->isMoved();
+        m_scheduler.update(accelerometer->isNearThreshold());
+    } while (wakePin == PRESSED_NONE && !moved);
 
     // Exiting the state
     wakeUpDisable();
@@ -140,8 +271,29 @@ State* StateSleep::enter() {
     }
 }
 
+uint8_t StateSleep::s_settlePeriod = 0xff;
+
+period_t StateSleep::settlePeriod() {
+    if (s_settlePeriod == 0xff) {
+        uint8_t period;
+        if (!RecordStore::read(RECORD_ACCEL_SETTLE, &period, sizeof(period)) || period > ACCEL_SETTLE_MAX) {
+            // Not calibrated or corrupted
+            period = ACCEL_SETTLE_MAX;
+        }
+        s_settlePeriod = period;
+    }
+    return (period_t)s_settlePeriod;
+}
+
+void StateSleep::saveSettlePeriod(period_t period) {
+    uint8_t value = period;
+    RecordStore::write(RECORD_ACCEL_SETTLE, &value, sizeof(value));
+    s_settlePeriod = value;
+}
+
 State* StateAwake::enter() {
     // Start up
+    ClockManager::slow(); // Only if the baud rate allows it.
     wakeUpEnable();
     accelerometer->powerOn();
     accelerometer->startADC();
@@ -150,7 +302,7 @@ State* StateAwake::enter() {
     for (uint8_t i = 0; i != IGNORE_CYCLES && wakePin == PRESSED_NONE; i++) {
         WATCHDOG_RESET;
         digitalWrite(LED_EXTERNAL, LOW);
-        LowPower.powerDown(SLEEP_250MS, ADC_ON, BOD_OFF); // Also time for startup
+        sleep(SLEEP_250MS, ADC_ON); // Also time for startup
         digitalWrite(LED_EXTERNAL, HIGH);
         accelerometer->isMoved(); // Ignore for a while
     }
@@ -169,6 +321,7 @@ State* StateAwake::enter() {
 
 State* StateAlert::enter() {
     // Start up
+    ClockManager::slow(); // Only if the baud rate allows it.
     wakeUpEnable();
     accelerometer->powerOn();
     accelerometer->startADC();
@@ -177,10 +330,11 @@ State* StateAlert::enter() {
     for (uint8_t i = 0; i != ALERT_CYCLES && wakePin == PRESSED_NONE; i++) {
         WATCHDOG_RESET;
         digitalWrite(LED_EXTERNAL, LOW);
-        LowPower.powerDown(SLEEP_250MS, ADC_ON, BOD_OFF); // Also time for startup
+        sleep(SLEEP_250MS, ADC_ON); // Also time for startup
         digitalWrite(LED_EXTERNAL, HIGH);
         if (accelerometer->isMoved()) {
             wakeUpDisable();
+            triggerLog->record(*accelerometer, armedTime());
             return states.countdown;
         }
     }
@@ -273,6 +427,7 @@ bool CodeEntry::playWithTune(uint16_t *background_tune) {
     // Starting code entry / countdown
     Serial.println("Waiting for code");
     uiBeep(background_tune);
+    StateStats::awake(State::accelerometer->isPowered()); // Charge the tune and boost from here on
 
     // Alternate tune playing
     SoundGenerator mute; // Does nothing
@@ -320,5 +475,6 @@ bool CodeEntry::playWithTune(uint16_t *background_tune) {
         }
         
     }
+    StateStats::awake(State::accelerometer->isPowered()); // Tune finished
     return check();
 }
\ No newline at end of file
@@ -2,7 +2,7 @@
  * See burglerAlarm.h for more info
  * 
  * Written by Jotham Gates
- * Last modified 27/01/2023
+ * Last modified 18/10/2026
  */
 #pragma once
 #include <Arduino.h>
@@ -10,15 +10,17 @@
 #include "../extensionsManager.h"
 #include "../../optimisations.h"
 #include "../../soundGeneration.h"
+#include "../../clock.h"
+#include "../../watchdog.h"
 #include "../../../tunes.h"
 
 #define ENCODE_CODE(CODE, LENGTH) (CODE<<4 | LENGTH)
-#define PREVIOUS_RECORDS 40
-#define STD_DEVIATIONS 3
-#define IGNORE_CYCLES 20
-#define ALERT_CYCLES 40
 
+#include "alarmSettings.h"
 #include "accelerometer.h"
+#include "adaptiveSleep.h"
+#include "triggerLog.h"
+#include "stateStats.h"
 
 #define MY_CODE ENCODE_CODE(0b1001011, 7)
 
@@ -53,8 +55,26 @@ class BurglerAlarmExtension : public Extension {
         void stateMachine();
         void onStart();
 
+        void onTuneStart() {
+            m_used = true;
+        }
+
     private:
+        bool m_used = false; // The horn has been played since starting.
+
+        void dumpLog();
+        void printStats();
+        void calibrateSettle();
 
+        /**
+         * @brief Powers up the accelerometer and measures how long it takes for
+         * the readings to settle.
+         * 
+         * @param accelerometer the accelerometer to use.
+         * @return uint16_t the time in ms after which all readings stayed
+         *         within ACCEL_SETTLE_TOLERANCE of the settled readings.
+         */
+        static uint16_t m_measureSettle(Acceleromenter& accelerometer);
 };
 
 /**
@@ -70,48 +90,97 @@ class State {
          *         machine, return nullptr.
          */
         virtual State* enter() {}
-        const __FlashStringHelper* name;
+        const StateId id;
         static StatesList states;
         static CodeEntry *codeEntry;
         static Acceleromenter *accelerometer;
+        static TriggerLog *triggerLog;
+
+        /**
+         * @brief Starts counting the time since the alarm was armed.
+         * 
+         */
+        static void arm();
+
+        /**
+         * @brief Returns the time since arm() was called in ms, including time
+         * spent asleep.
+         * 
+         * @return uint32_t 
+         */
+        static uint32_t armedTime();
 
     protected:
-        State(const __FlashStringHelper* name) : name(name) {}
+        State(const StateId id) : id(id) {}
+
+        /**
+         * @brief Puts the microcontroller into power down mode and keeps track
+         * of the time spent asleep.
+         * 
+         * @param period how long to sleep for.
+         * @param adc whether to leave the ADC on.
+         */
+        static void sleep(period_t period, adc_t adc);
+
+    private:
+        static uint32_t m_armedMillis;
+        static uint32_t m_sleptTime;
 };
 
 class StateInit : public State {
     public:
-        StateInit(): State(F("Init")) {}
+        StateInit(): State(STATE_INIT) {}
         virtual State* enter();
 };
 
 class StateSleep : public State {
     public:
-        StateSleep(): State(F("Sleep")) {}
+        StateSleep(): State(STATE_SLEEP), m_scheduler(SLEEP_PERIOD_MIN, SLEEP_PERIOD_MAX, SLEEP_QUIET_SAMPLES), m_settlePeriod(settlePeriod()) {}
         virtual State* enter();
+
+        /**
+         * @brief Returns the time to wait for the accelerometer to start up,
+         * or ACCEL_SETTLE_MAX if it hasn't been calibrated. Read from EEPROM
+         * the first time and kept in RAM after that.
+         * 
+         * @return period_t 
+         */
+        static period_t settlePeriod();
+
+        /**
+         * @brief Saves a new settle time to EEPROM and RAM.
+         * 
+         * @param period the time to wait for the accelerometer to start up.
+         */
+        static void saveSettlePeriod(period_t period);
+
+    private:
+        AdaptiveSleep m_scheduler;
+        const period_t m_settlePeriod;
+        static uint8_t s_settlePeriod; // 0xff until read from EEPROM.
 };
 
 class StateAwake : public State {
     public:
-        StateAwake(): State(F("Awake")) {}
+        StateAwake(): State(STATE_AWAKE) {}
         virtual State* enter();
 };
 
 class StateAlert : public State {
     public:
-        StateAlert(): State(F("Alert")) {}
+        StateAlert(): State(STATE_ALERT) {}
         virtual State* enter();
 };
 
 class StateCountdown : public State {
     public:
-        StateCountdown(): State(F("Countdown")) {}
+        StateCountdown(): State(STATE_COUNTDOWN) {}
         virtual State* enter();
 };
 
 class StateSiren : public State {
     public:
-        StateSiren(): State(F("Sirn")) {}
+        StateSiren(): State(STATE_SIREN) {}
         virtual State* enter();
 };
 
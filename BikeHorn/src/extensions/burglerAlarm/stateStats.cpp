@@ -0,0 +1,110 @@
+/** stateStats.cpp
+ * See stateStats.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include "burglerAlarm.h"
+
+extern TunePlayer tune;
+
+StateRecord StateStats::s_records[STATE_COUNT];
+StateId StateStats::s_state = STATE_INIT;
+uint32_t StateStats::s_mark;
+uint32_t StateStats::s_current;
+
+// State names, in the same order as StateId.
+const char nameInit[] PROGMEM = "Init";
+const char nameSleep[] PROGMEM = "Sleep";
+const char nameAwake[] PROGMEM = "Awake";
+const char nameAlert[] PROGMEM = "Alert";
+const char nameCountdown[] PROGMEM = "Countdown";
+const char nameSiren[] PROGMEM = "Siren";
+const char *const stateNames[] PROGMEM = {nameInit, nameSleep, nameAwake, nameAlert, nameCountdown, nameSiren};
+
+void StateStats::begin() {
+    memset(s_records, 0, sizeof(s_records));
+    s_state = STATE_INIT;
+    s_mark = millis();
+    s_current = m_current(false);
+}
+
+void StateStats::enter(StateId state) {
+    s_state = state;
+    s_records[state].entries++;
+    s_mark = millis();
+}
+
+void StateStats::awake(bool accelerometer) {
+    uint32_t now = millis();
+    m_add(now - s_mark, s_current);
+    s_mark = now;
+    s_current = m_current(accelerometer);
+}
+
+uint32_t StateStats::m_current(bool accelerometer) {
+    uint32_t current = ClockManager::isSlow() ? CURRENT_ACTIVE_SLOW : CURRENT_ACTIVE;
+    if (accelerometer) {
+        current += CURRENT_ACCELEROMETER;
+    }
+    if (bit_is_set(ADCSRA, ADEN)) {
+        current += CURRENT_ADC;
+    }
+    if (BoostManager::isRunning()) {
+        current += CURRENT_BOOST;
+    }
+    if (tune.isPlaying()) {
+        current += CURRENT_SOUND;
+    }
+    return current;
+}
+
+void StateStats::asleep(uint16_t time, bool adc, bool accelerometer) {
+    uint32_t current = CURRENT_POWER_DOWN;
+    if (accelerometer) {
+        current += CURRENT_ACCELEROMETER;
+    }
+    if (adc && bit_is_set(ADCSRA, ADEN)) {
+        current += CURRENT_ADC;
+    }
+    m_add(time, current);
+}
+
+void StateStats::print() {
+    Serial.println(F("State,Entries,Time (ms),Charge (uC),Average (uA)"));
+    uint32_t totalTime = 0;
+    float totalCharge = 0;
+    for (uint8_t i = 0; i < STATE_COUNT; i++) {
+        const StateRecord& record = s_records[i];
+        Serial.print(name((StateId)i));
+        Serial.print(',');
+        Serial.print(record.entries);
+        Serial.print(',');
+        Serial.print(record.time);
+        Serial.print(',');
+        Serial.print(record.charge);
+        Serial.print(',');
+        Serial.println(record.time ? record.charge * 1000 / record.time : 0);
+        totalTime += record.time;
+        totalCharge += record.charge;
+    }
+    Serial.print(F("Total,,"));
+    Serial.print(totalTime);
+    Serial.print(',');
+    Serial.print(totalCharge);
+    Serial.print(',');
+    Serial.println(totalTime ? totalCharge * 1000 / totalTime : 0);
+    Serial.print(F("Total (mAh): "));
+    Serial.println(totalCharge / 3600000, 4);
+}
+
+const __FlashStringHelper* StateStats::name(StateId state) {
+    return (const __FlashStringHelper*)pgm_read_ptr(&stateNames[state]);
+}
+
+void StateStats::m_add(uint32_t time, uint32_t current) {
+    s_records[s_state].time += time;
+    s_records[s_state].charge += (float)time * current / 1000;
+}
\ No newline at end of file
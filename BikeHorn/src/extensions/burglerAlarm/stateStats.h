@@ -0,0 +1,119 @@
+/** stateStats.h
+ * Keeps track of how many times each burgler alarm state was entered, how long
+ * was spent in it and roughly how much charge it used.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#pragma once
+
+/**
+ * @brief Index of each state in the statistics.
+ * 
+ */
+enum StateId : uint8_t {
+    STATE_INIT,
+    STATE_SLEEP,
+    STATE_AWAKE,
+    STATE_ALERT,
+    STATE_COUNTDOWN,
+    STATE_SIREN,
+    STATE_COUNT
+};
+
+/**
+ * @brief Statistics for a single state.
+ * 
+ */
+struct StateRecord {
+    uint16_t entries; // Number of times the state was entered.
+    uint32_t time; // Total time spent in the state in ms, including time asleep.
+    float charge; // Estimated charge used in uC (uA.s).
+};
+
+/**
+ * @brief Class for accounting the time and charge used by each state.
+ * 
+ * The charge is estimated from the current model in alarmSettings.h. While
+ * awake, the time is measured with millis() and the current is worked out from
+ * what is turned on at the start of each period, so awake() needs to be called
+ * whenever something that draws a lot (the boost stage or a tune) starts or
+ * stops. Time spent asleep is added using the nominal watchdog period, so may
+ * be off by 10% or so.
+ * 
+ * Everything is static so that the last arming can still be printed from the
+ * menu once the state machine has exited.
+ * 
+ */
+class StateStats {
+    public:
+        /**
+         * @brief Clears the statistics. Call when the alarm is started.
+         * 
+         */
+        static void begin();
+
+        /**
+         * @brief Starts accounting to the given state.
+         * 
+         * @param state the state being entered.
+         */
+        static void enter(StateId state);
+
+        /**
+         * @brief Adds the time since the last call of awake() or enter() to the
+         * current state at the current drawn then, and notes what is on from
+         * now. Call before going to sleep, when leaving a state and just after
+         * a tune or the boost stage starts or stops.
+         * 
+         * @param accelerometer true if the accelerometer is powered.
+         */
+        static void awake(bool accelerometer);
+
+        /**
+         * @brief Adds time spent asleep to the current state.
+         * 
+         * @param time the time asleep in ms.
+         * @param adc true if the ADC was left on while asleep.
+         * @param accelerometer true if the accelerometer was powered.
+         */
+        static void asleep(uint16_t time, bool adc, bool accelerometer);
+
+        /**
+         * @brief Prints a table of the statistics over serial.
+         * 
+         */
+        static void print();
+
+        /**
+         * @brief Returns the name of a state.
+         * 
+         * @param state 
+         * @return const __FlashStringHelper* 
+         */
+        static const __FlashStringHelper* name(StateId state);
+
+    private:
+        /**
+         * @brief Adds time to the current state at the given current.
+         * 
+         * @param time in ms.
+         * @param current in uA.
+         */
+        static void m_add(uint32_t time, uint32_t current);
+
+        /**
+         * @brief Works out the current being drawn from what is switched on.
+         * 
+         * @param accelerometer true if the accelerometer is powered.
+         * @return uint32_t the current in uA.
+         */
+        static uint32_t m_current(bool accelerometer);
+
+        static StateRecord s_records[STATE_COUNT];
+        static StateId s_state;
+        static uint32_t s_mark;
+        static uint32_t s_current; // Current drawn since s_mark in uA.
+};
\ No newline at end of file
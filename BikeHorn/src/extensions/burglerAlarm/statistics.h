@@ -2,11 +2,11 @@
  * Statistics used for movement detection.
  * 
  * Written by Jotham Gates
- * Last modified 22/12/2022
+ * Last modified 18/10/2026
  */
 
 #pragma once
-#include <cppQueue.h>
+#include "../../ringBuffer.h"
 
 /**
  * @brief Class for calculating incremental standard deviations.
@@ -100,8 +100,10 @@ class IncrementalStdDev {
  * 
  * @tparam DataType is the data type to use for testing. This must support
  * negative numbers (can't be unsigned).
+ * @tparam StoreType is the data type used to keep the history of samples. This
+ * can be smaller than DataType if the samples are always whole numbers.
  */
-template <typename DataType>
+template <typename DataType, typename StoreType = DataType>
 class NullHypothesis {
     public:
         /**
@@ -134,8 +136,23 @@ class NullHypothesis {
         static bool isUnlikely(DataType value, DataType mean, DataType stdDev) {
             // Based on the last x readings, is it likely that this value is
             // from the same set?
+            return isOutside(value, mean, stdDev, STD_DEVIATIONS);
+        }
+
+        /**
+         * @brief Checks if the given value is more than a given number of
+         * standard deviations from the mean.
+         * 
+         * @param value the value to compare to the saved samples.
+         * @param mean the mean to use.
+         * @param stdDev the standard deviation to use.
+         * @param deviations the number of standard deviations allowed.
+         * @return true if the value is further away than allowed.
+         * @return false if the value is within the allowed range.
+         */
+        static bool isOutside(DataType value, DataType mean, DataType stdDev, DataType deviations) {
             DataType difference = value - mean;
-            return abs(difference) > STD_DEVIATIONS*stdDev;
+            return abs(difference) > deviations*stdDev;
         }
 
         /**
@@ -145,13 +162,12 @@ class NullHypothesis {
          */
         void update(DataType value) {
             // Remove the old value from the queue and standard deviation.
-            DataType old;
-            m_queue.pop(&old);
-            standardDev.remove(old);
+            if (m_queue.isFull()) {
+                standardDev.remove(m_queue.pop());
+            }
 
             // Add the new value
-            m_queue.push(&value);
-            standardDev.add(value);
+            add(value);
         }
 
         /**
@@ -161,7 +177,7 @@ class NullHypothesis {
          * @param value is the value to add.
          */
         void add(DataType value) {
-            m_queue.push(&value);
+            m_queue.push((StoreType)value);
             standardDev.add(value);
         }
     
@@ -172,5 +188,170 @@ class NullHypothesis {
         IncrementalStdDev standardDev;
 
     private:
-        cppQueue m_queue = cppQueue(sizeof(DataType), PREVIOUS_RECORDS, FIFO, true);
+        RingBuffer<StoreType, PREVIOUS_RECORDS> m_queue;
+};
+
+/**
+ * @brief Class for detecting changes with an exponentially weighted moving
+ * average (EWMA) and cumulative sum (CUSUM) of the deviations from it.
+ * 
+ * An alternative to NullHypothesis (select with ACCEL_EWMA_CUSUM in
+ * alarmSettings.h) that uses a few bytes regardless of PREVIOUS_RECORDS and
+ * only integer maths for each sample. A value is unlikely if either:
+ * - It is more than STD_DEVIATIONS from the mean (as in NullHypothesis).
+ * - The deviations from the mean that are more than CUSUM_SLACK / 8 standard
+ *   deviations in the same direction add up to more than CUSUM_LIMIT standard
+ *   deviations. This catches slow changes such as the bike being wheeled away
+ *   where no single value stands out.
+ * 
+ * Values are stored with 4 fractional bits (multiplied by 16) and deviations
+ * are clamped to EWMA_CLAMP so that the squares fit in 32 bits.
+ * 
+ */
+class EwmaCusum {
+    public:
+        /**
+         * @brief Adds a value to the mean and variance without testing it.
+         * Averages evenly until there are 2^EWMA_SHIFT values (including ones
+         * added by isUnlikely()) so that calibrating does not have to wait for
+         * the average to settle.
+         * 
+         * @param value the value to add.
+         */
+        void add(int16_t value) {
+            if (m_count == 0) {
+                m_count = 1;
+                m_mean = value * 16; // Nothing to average with yet.
+                return;
+            }
+            m_update(m_deviation(value));
+        }
+
+        /**
+         * @brief Tests a value and adds it to the mean and variance if it
+         * isn't unlikely.
+         * 
+         * @param value the value to test.
+         * @return true if the value (or the drift leading up to it) is
+         *         unlikely to be noise.
+         * @return false if it could be noise.
+         */
+        bool isUnlikely(int16_t value) {
+            int16_t deviation = m_deviation(value);
+            uint32_t square = (int32_t)deviation * deviation;
+
+            // CUSUM in both directions
+            m_high = max(m_high + deviation - m_slack, 0);
+            m_low = max(m_low - deviation - m_slack, 0);
+            bool drifted = m_high > m_limit || m_low > m_limit;
+            bool outside = square > (uint32_t)(STD_DEVIATIONS * STD_DEVIATIONS) * m_variance;
+            m_near = outside || drifted || square > (uint32_t)(NEAR_STD_DEVIATIONS * NEAR_STD_DEVIATIONS) * m_variance
+                || m_high > m_limit / 2 || m_low > m_limit / 2;
+
+            if (drifted) {
+                // Start again so that the same drift isn't reported every time.
+                m_high = 0;
+                m_low = 0;
+            }
+            if (!outside && !drifted) {
+                m_update(deviation);
+            }
+            return outside || drifted;
+        }
+
+        /**
+         * @brief Returns true if the last value tested was close to (or over)
+         * being unlikely (NEAR_STD_DEVIATIONS from the mean or over half way
+         * to the CUSUM limit).
+         * 
+         */
+        inline bool isNear() const {
+            return m_near;
+        }
+
+        /**
+         * @brief Returns the mean.
+         * 
+         * @return double 
+         */
+        inline double mean() const {
+            return m_mean / 16.0;
+        }
+
+        /**
+         * @brief Returns the standard deviation.
+         * 
+         * @return double 
+         */
+        inline double std() const {
+            return m_std / 16.0;
+        }
+
+    private:
+        /**
+         * @brief Works out how far a value is from the mean, clamped to
+         * EWMA_CLAMP.
+         * 
+         * @param value the value.
+         * @return int16_t the deviation with 4 fractional bits.
+         */
+        int16_t m_deviation(int16_t value) const {
+            int16_t deviation = value * 16 - m_mean;
+            return constrain(deviation, -EWMA_CLAMP * 16, EWMA_CLAMP * 16);
+        }
+
+        /**
+         * @brief Moves the mean and variance towards a value and updates the
+         * standard deviation and CUSUM thresholds.
+         * 
+         * @param deviation the value's deviation from the mean.
+         */
+        void m_update(int16_t deviation) {
+            uint32_t square = (int32_t)deviation * deviation;
+            if (m_count != EWMA_COUNT) {
+                // Still calibrating, so use the average of everything so far.
+                m_count++;
+                m_mean += deviation / m_count;
+                m_variance += ((int32_t)square - (int32_t)m_variance) / m_count;
+            } else {
+                // Divide rather than shift as >> rounds negative numbers down,
+                // which would drag the mean (and variance) down over time.
+                m_mean += deviation / EWMA_COUNT;
+                m_variance += ((int32_t)square - (int32_t)m_variance) / EWMA_COUNT;
+            }
+
+            // Keep the standard deviation at least 1 as NullHypothesis does.
+            m_std = max(m_sqrt(m_variance), 16);
+            m_slack = m_std * CUSUM_SLACK / 8;
+            m_limit = (int32_t)m_std * CUSUM_LIMIT;
+        }
+
+        /**
+         * @brief Integer square root.
+         * 
+         * @param value the number to find the square root of.
+         * @return uint16_t the square root, rounded down.
+         */
+        static uint16_t m_sqrt(uint32_t value) {
+            uint16_t result = 0;
+            for (uint16_t bit = 0x400; bit; bit >>= 1) { // Clamping keeps the root under 0x800.
+                uint16_t trial = result | bit;
+                if ((uint32_t)trial * trial <= value) {
+                    result = trial;
+                }
+            }
+            return result;
+        }
+
+        static const uint8_t EWMA_COUNT = 1 << EWMA_SHIFT;
+
+        int16_t m_mean = 0;
+        uint32_t m_variance = 0;
+        uint16_t m_std = 16;
+        uint16_t m_slack = 0;
+        int32_t m_limit = 0;
+        int32_t m_high = 0;
+        int32_t m_low = 0;
+        uint8_t m_count = 0;
+        bool m_near = false;
 };
\ No newline at end of file
@@ -0,0 +1,120 @@
+/** triggerLog.cpp
+ * See triggerLog.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include <stddef.h>
+#include <util/crc16.h>
+#include "burglerAlarm.h"
+
+const uint8_t *volatile TriggerLog::s_data;
+volatile uint16_t TriggerLog::s_address;
+volatile uint8_t TriggerLog::s_remaining = 0;
+
+void TriggerLog::record(const Acceleromenter& accelerometer, uint32_t armedTime) {
+    // Can't change the record while it is still being written.
+    flush();
+
+    // Fill out the record
+    uint8_t slot = m_nextSlot(m_record.sequence);
+    m_record.axes = accelerometer.movedAxes();
+    m_record.armedTime = armedTime;
+    for (uint8_t i = 0; i < 3; i++) {
+        const AccelerometerAxis& axis = accelerometer.axis(i);
+        const RingBuffer<int16_t, ALARM_LOG_CHANGES>& recent = axis.recentChanges();
+        for (uint8_t j = 0; j < ALARM_LOG_CHANGES; j++) {
+            // Oldest first, padding with 0 if there haven't been enough readings.
+            uint8_t age = ALARM_LOG_CHANGES - 1 - j;
+            m_record.axis[i].changes[j] = age < recent.count() ? recent.peekNewest(age) : 0;
+        }
+        m_record.axis[i].mean = axis.mean();
+        m_record.axis[i].std = axis.std();
+    }
+    m_record.crc = m_crc(m_record);
+
+    // Start writing in the background
+    s_data = (const uint8_t*)&m_record;
+    s_address = EEPROM_ALARM_LOG + slot * sizeof(TriggerRecord);
+    s_remaining = sizeof(TriggerRecord);
+    TRACE(TRACE_EEPROM_WRITE, s_address);
+    EECR |= bit(EERIE);
+    Serial.print(F("Logging trigger to slot "));
+    Serial.println(slot);
+}
+
+void TriggerLog::flush() const {
+    while (s_remaining || !eeprom_is_ready()) {
+        WATCHDOG_RESET;
+    }
+}
+
+void TriggerLog::dump() {
+    Serial.write("ALOG");
+    Serial.write(TRIGGER_LOG_VERSION);
+    Serial.write(EEPROM_ALARM_LOG_RECORDS);
+    Serial.write(sizeof(TriggerRecord));
+    for (uint16_t i = 0; i < EEPROM_ALARM_LOG_RECORDS * sizeof(TriggerRecord); i++) {
+        Serial.write(EEPROM.read(EEPROM_ALARM_LOG + i));
+    }
+    Serial.flush();
+}
+
+uint16_t TriggerLog::m_crc(const TriggerRecord &record) {
+    // Starting with the version means records from an older format and a
+    // region of zeros both fail.
+    const uint8_t *data = (const uint8_t*)&record;
+    uint16_t crc = _crc_xmodem_update(0, TRIGGER_LOG_VERSION);
+    for (uint8_t i = 0; i < offsetof(TriggerRecord, crc); i++) {
+        crc = _crc_xmodem_update(crc, data[i]);
+    }
+    return crc;
+}
+
+uint8_t TriggerLog::m_nextSlot(uint8_t &sequence) {
+    // Only the sequence number of each record is needed after checking it.
+    uint8_t sequences[EEPROM_ALARM_LOG_RECORDS];
+    bool valid[EEPROM_ALARM_LOG_RECORDS];
+    for (uint8_t slot = 0; slot < EEPROM_ALARM_LOG_RECORDS; slot++) {
+        TriggerRecord record;
+        eeprom_read_block(&record, (const void*)(EEPROM_ALARM_LOG + slot * sizeof(TriggerRecord)), sizeof(TriggerRecord));
+        valid[slot] = record.crc == m_crc(record);
+        sequences[slot] = record.sequence;
+    }
+
+    // The newest record is the valid one where the next record is not valid or
+    // its sequence number is not one more.
+    for (uint8_t slot = 0; slot < EEPROM_ALARM_LOG_RECORDS; slot++) {
+        if (valid[slot]) {
+            uint8_t next = slot + 1 == EEPROM_ALARM_LOG_RECORDS ? 0 : slot + 1;
+            sequence = sequences[slot] + 1;
+            if (!valid[next] || sequences[next] != sequence) {
+                return next;
+            }
+        }
+    }
+
+    // Empty log.
+    sequence = 0;
+    return 0;
+}
+
+/**
+ * @brief Writes the next byte of a record each time the EEPROM is ready.
+ * 
+ */
+ISR(EE_READY_vect) {
+    if (TriggerLog::s_remaining) {
+        EEAR = TriggerLog::s_address++;
+        EEDR = *TriggerLog::s_data++;
+        EECR |= bit(EEMPE);
+        EECR |= bit(EEPE); // Must be within 4 clock cycles of setting EEMPE
+        TriggerLog::s_remaining--;
+    } else {
+        // Finished
+        EECR &= ~bit(EERIE);
+        TRACE(TRACE_EEPROM_DONE, 0);
+    }
+}
\ No newline at end of file
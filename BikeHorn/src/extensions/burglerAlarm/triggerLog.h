@@ -0,0 +1,94 @@
+/** triggerLog.h
+ * Records why the burgler alarm went off to a small ring of records in EEPROM
+ * so that the thresholds can be tuned from real events.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#pragma once
+
+#define TRIGGER_LOG_VERSION 2
+
+/**
+ * @brief A single record as stored in EEPROM (little endian, floats are 4 byte
+ * IEEE 754).
+ * 
+ * Records with the wrong CRC (never written, partly written or left over from
+ * whatever used to be stored there) are treated as empty.
+ * 
+ */
+struct TriggerRecord {
+    uint8_t sequence; // Increments with each record so the newest can be found.
+    uint8_t axes; // Axes that tripped. Bit 0 is x, bit 1 is y, bit 2 is z.
+    uint32_t armedTime; // Time since the alarm was armed in ms.
+    struct {
+        int16_t changes[ALARM_LOG_CHANGES]; // Oldest first. The last one caused the trigger.
+        float mean;
+        float std;
+    } axis[3];
+    uint16_t crc; // CRC-16/XMODEM of TRIGGER_LOG_VERSION then everything before it (the same CRC as recordStore.h).
+} __attribute__((packed));
+
+static_assert(sizeof(TriggerRecord) * EEPROM_ALARM_LOG_RECORDS <= EEPROM_ALARM_LOG_SIZE, "EEPROM_ALARM_LOG_SIZE is too small for the trigger log");
+
+/**
+ * @brief Class for writing triggers to EEPROM in the background.
+ * 
+ * Writing a record takes around 3.3ms per byte, so this is done one byte at a
+ * time from the EEPROM ready interrupt so that the countdown is not held up.
+ * 
+ */
+class TriggerLog {
+    public:
+        /**
+         * @brief Starts writing a record of the latest reading from the
+         * accelerometer in the background.
+         * 
+         * @param accelerometer the accelerometer that was moved.
+         * @param armedTime the time since the alarm was armed in ms.
+         */
+        void record(const Acceleromenter& accelerometer, uint32_t armedTime);
+
+        /**
+         * @brief Waits until any record being written has been written.
+         * 
+         */
+        void flush() const;
+
+        /**
+         * @brief Sends the log over serial in binary.
+         * 
+         * The format is "ALOG", then 1 byte each for the version, number of
+         * records and size of each record, followed by the records in the order
+         * they are stored in EEPROM.
+         * 
+         */
+        static void dump();
+
+        // Used by the EEPROM ready interrupt.
+        static const uint8_t *volatile s_data;
+        static volatile uint16_t s_address;
+        static volatile uint8_t s_remaining;
+
+    private:
+        /**
+         * @brief Calculates the CRC of a record.
+         * 
+         * @param record the record.
+         * @return uint16_t the CRC of TRIGGER_LOG_VERSION and everything
+         *                  before the crc field.
+         */
+        static uint16_t m_crc(const TriggerRecord &record);
+
+        /**
+         * @brief Finds the slot to write the next record to.
+         * 
+         * @param sequence is set to the sequence number to use for the record.
+         * @return uint8_t the slot.
+         */
+        static uint8_t m_nextSlot(uint8_t &sequence);
+
+        TriggerRecord m_record;
+};
\ No newline at end of file
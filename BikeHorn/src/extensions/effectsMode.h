@@ -0,0 +1,64 @@
+/** effectsMode.h
+ * Applies each tune's effect (tuneEffects in tunes.h) while the horn is
+ * playing, and adds a menu item to override it with one of a few effects
+ * instead.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "extensionsManager.h"
+#include "../effects.h"
+
+// Effects that can be selected from the menu to use instead of each tune's own.
+const Effect effectModes[] PROGMEM = {
+    NO_EFFECT,
+    VIBRATO(10, 40), // About 6Hz, 40 cents either side
+    TREMOLO(8, 60), // About 8Hz
+    ARPEGGIO(25, 3, 0, 4, 7), // Major chord
+    ARPEGGIO(25, 3, 0, 3, 7) // Minor chord
+};
+#define EFFECT_MODES (sizeof(effectModes) / sizeof(Effect))
+
+class EffectsExtension: public Extension {
+    public:
+        EffectsExtension() {
+            menuActions.length = 1;
+            menuActions.array = (MenuItem*)malloc(sizeof(MenuItem));
+            menuActions.array[0] = (MenuItem)&EffectsExtension::nextMode;
+        }
+
+        void onTuneStart() {
+#ifdef ENABLE_WARBLE
+            if (curTune == tuneCount) {
+                return; // Warble mode has its own sweep.
+            }
+#endif
+            piezo.setEffect(s_mode ? &effectModes[s_mode - 1] : &tuneEffects[curTune]);
+        }
+
+        void onTuneStop() {
+            piezo.setEffect(nullptr); // So that UI beeps are plain
+        }
+
+    private:
+        /**
+         * @brief Moves to the next effect mode. Mode 0 uses each tune's own
+         * effect.
+         * 
+         */
+        void nextMode() {
+            s_mode++;
+            if (s_mode > EFFECT_MODES) {
+                s_mode = 0;
+            }
+            Serial.print(F("Effect mode "));
+            Serial.println(s_mode);
+            uiBeep(const_cast<uint16_t*>(beeps::acknowledge));
+        }
+
+        static uint8_t s_mode;
+};
+
+uint8_t EffectsExtension::s_mode = 0;
\ No newline at end of file
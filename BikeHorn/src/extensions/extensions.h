@@ -3,7 +3,7 @@
  * configuration for which extensions are enabled.
  * 
  * Written by Jotham Gates
- * Last modified 01/11/2022
+ * Last modified 18/10/2026
  */
 #pragma once
 #include "extensionsManager.h"
@@ -29,6 +29,27 @@ MeasureBatteryExtension measureBattery;
 #include "burglerAlarm/burglerAlarm.h"
 BurglerAlarmExtension burglerAlarm;
 
+#include "effectsMode.h"
+EffectsExtension effectsMode;
+
+#include "profileMode.h"
+ProfileExtension profileMode;
+
+#ifdef ENABLE_SAMPLES
+#include "sampleMode.h"
+SampleExtension sampleMode;
+#endif
+
+#ifdef ENABLE_TRACE
+#include "traceDump.h"
+TraceDumpExtension traceDump;
+#endif
+
+#ifdef RAM_DEBUG
+#include "ramReport.h"
+RamReportExtension ramReport;
+#endif
+
 // Array of extensions. This will be the order they appear in the menu if they have menu items.
 Extension* extensionsList[] = {
     // &exampleExtension,
@@ -38,7 +59,18 @@ Extension* extensionsList[] = {
 #endif
     &midiSynth,
     &measureBattery,
-    &burglerAlarm
+    &burglerAlarm,
+    &effectsMode,
+    &profileMode,
+#ifdef ENABLE_SAMPLES
+    &sampleMode,
+#endif
+#ifdef ENABLE_TRACE
+    &traceDump,
+#endif
+#ifdef RAM_DEBUG
+    &ramReport,
+#endif
 };
 
 // Setting up the extensions manager
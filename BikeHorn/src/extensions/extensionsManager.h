@@ -3,10 +3,12 @@
  * classes for extensions.
  * 
  * Written by Jotham Gates
- * Last modified 01/11/2022
+ * Last modified 18/10/2026
  */
 #pragma once
 #include "../../defines.h"
+#include "../trace.h"
+#include "../clock.h"
 
 // External methods and variables
 extern void uiBeep(uint16_t* beep);
@@ -31,7 +33,9 @@ class Extension {
         }
         
         /**
-         * @brief Called when the horn starts up.
+         * @brief Called once the horn is first idle after starting up. If the
+         * horn button was held while starting, the other hooks are called for
+         * that before this.
          * 
          */
         virtual void onStart() {}
@@ -82,7 +86,8 @@ class ExtensionManager {
         ExtensionManager(Array<Extension*>& extensionsArray) : extensions(extensionsArray) {}
 
         /**
-         * @brief Calls all extensions on startup.
+         * @brief Calls all extensions once the horn is first idle after
+         * starting up.
          * 
          */
         void callOnStart() {
@@ -90,8 +95,10 @@ class ExtensionManager {
             Serial.print(extensions.length);
             Serial.println(F(" extensions installed"));
             for (uint8_t i = 0; i < extensions.length; i++) {
+                TRACE(TRACE_EXT_START, i);
                 extensions.array[i]->onStart();
             }
+            TRACE(TRACE_EXT_DONE, TRACE_EXT_START);
         }
 
         /**
@@ -100,8 +107,10 @@ class ExtensionManager {
          */
         void callOnWake() {
             for (uint8_t i = 0; i < extensions.length; i++) {
+                TRACE(TRACE_EXT_WAKE, i);
                 extensions.array[i]->onWake();
             }
+            TRACE(TRACE_EXT_DONE, TRACE_EXT_WAKE);
         }
 
         /**
@@ -110,8 +119,10 @@ class ExtensionManager {
          */
         void callOnSleep() {
             for (uint8_t i = 0; i < extensions.length; i++) {
+                TRACE(TRACE_EXT_SLEEP, i);
                 extensions.array[i]->onSleep();
             }
+            TRACE(TRACE_EXT_DONE, TRACE_EXT_SLEEP);
         }
 
         /**
@@ -120,8 +131,10 @@ class ExtensionManager {
          */
         void callOnTuneStart() {
             for (uint8_t i = 0; i < extensions.length; i++) {
+                TRACE(TRACE_EXT_TUNE_START, i);
                 extensions.array[i]->onTuneStart();
             }
+            TRACE(TRACE_EXT_DONE, TRACE_EXT_TUNE_START);
         }
 
         /**
@@ -130,8 +143,10 @@ class ExtensionManager {
          */
         void callOnTuneStop() {
             for (uint8_t i = 0; i < extensions.length; i++) {
+                TRACE(TRACE_EXT_TUNE_STOP, i);
                 extensions.array[i]->onTuneStop();
             }
+            TRACE(TRACE_EXT_DONE, TRACE_EXT_TUNE_STOP);
         }
 
         /**
@@ -151,6 +166,7 @@ class ExtensionManager {
                 while (millis() - lastInteractionTime < MENU_TIMEOUT) {
                     WATCHDOG_RESET;
                     tune.update();
+                    ClockManager::slow();
                     if (IS_PRESSED(BUTTON_MODE)) {
                         digitalWrite(LED_EXTERNAL, LOW);
                         uint32_t pressTime = modeButtonPress();
@@ -224,6 +240,8 @@ class ExtensionManager {
             Serial.print(extension);
             Serial.print(F(" that appeared in the menu as item "));
             Serial.println(index);
+            TRACE(TRACE_EXT_MENU, extension);
             extensions.array[extension]->menuActions.array[extensionIndex]();
+            TRACE(TRACE_EXT_DONE, TRACE_EXT_MENU);
         }
 };
\ No newline at end of file
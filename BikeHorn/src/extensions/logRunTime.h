@@ -6,14 +6,14 @@
  * extension for maintainability.
  * 
  * Written by Jotham Gates
- * Last modified 01/11/2022
+ * Last modified 18/10/2026
  */
 #pragma once
 #include "extensionsManager.h"
 #include <EEPROMWearLevel.h>
 
-#define LOG_VERSION 3
-#define EEPROM_WEAR_LEVEL_LENGTH 1024 - 2*EEPROM_PIECEWISE_SIZE // Leave enough space at the end for the optimiser settings
+#define LOG_VERSION 7
+#define EEPROM_WEAR_LEVEL_LENGTH EEPROM_ALARM_LOG // Leave enough space at the end for the alarm log and records
 
 class RunTimeLogger: public Extension {
     public:
@@ -24,7 +24,7 @@ class RunTimeLogger: public Extension {
         }
 
         void onStart() {
-            EEPROMwl.begin(LOG_VERSION, 2, EEPROM_WEAR_LEVEL_LENGTH);
+            m_begin();
             Serial.print(F("Run time logging enabled. Horn has been sounding for "));
             Serial.print(getTime() / 1000);
             Serial.println(F(" seconds."));
@@ -38,12 +38,22 @@ class RunTimeLogger: public Extension {
         }
 
         void onTuneStop() {
+            m_begin(); // In case the horn was used before onStart()
             addTime(millis() - wakeTime);
             addBeep();
         }
     
     private:
         uint32_t wakeTime;
+        bool m_begun = false;
+
+        /** Starts the wear levelling if it hasn't been already */
+        inline void m_begin() {
+            if (!m_begun) {
+                EEPROMwl.begin(LOG_VERSION, 2, EEPROM_WEAR_LEVEL_LENGTH);
+                m_begun = true;
+            }
+        }
 
         /** @returns the time the horn has been sounding in ms */
         inline uint32_t getTime() {
@@ -55,6 +65,7 @@ class RunTimeLogger: public Extension {
         /** Add @param time in ms to the total time the horn has been sounding */
         inline void addTime(uint32_t time) {
             time += getTime();
+            TRACE(TRACE_EEPROM_WRITE, 0);
             EEPROMwl.put(0, time);
         }
 
@@ -68,6 +79,7 @@ class RunTimeLogger: public Extension {
         /** Adds 1 to the number of times the horn has gone off */
         inline void addBeep() {
             uint16_t beeps = getBeeps() + 1;
+            TRACE(TRACE_EEPROM_WRITE, 1);
             EEPROMwl.put(1, beeps);
         }
 
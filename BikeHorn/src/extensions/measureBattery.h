@@ -3,10 +3,12 @@
  * 
  * Written by Jotham Gates
  * Created 09/07/2022
- * Last modified 27/06/2023
+ * Last modified 18/10/2026
  */
 #pragma once
 #include "extensionsManager.h"
+#include "../power.h"
+#include "../clock.h"
 
 class MeasureBatteryExtension: public Extension {
     public:
@@ -38,8 +40,8 @@ class MeasureBatteryExtension: public Extension {
          * @return uint32_t the voltage in mv.
          */
         uint32_t readVcc() {
-            ADCSRA =  bit (ADEN);   // turn ADC on
-            ADCSRA |= bit (ADPS0) |  bit (ADPS1) | bit (ADPS2);  // Prescaler of 128
+            PowerManager::acquire(POWER_ADC);
+            ADCSRA = bit(ADEN) | ClockManager::adcPrescaler(); // turn ADC on
 
             // Read 1.1V reference against AVcc
             // set the reference to Vcc and the measurement to the internal 1.1V reference
@@ -60,6 +62,7 @@ class MeasureBatteryExtension: public Extension {
             
             uint32_t result = (high<<8) | low;
             
+            PowerManager::release(POWER_ADC); // Turns the ADC off unless the accelerometer is using it
             result = 1125300L / result; // Calculate Vcc (in mV); 1125300 = 1.1*1023*1000
             return result; // Vcc in millivolts
         }
@@ -0,0 +1,177 @@
+/** midiParser.h
+ * Classes for decoding a MIDI byte stream one byte at a time and keeping track
+ * of which notes are held down.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+
+// Channel message types (upper nibble of the status byte).
+#define MIDI_NOTE_OFF 0x80
+#define MIDI_NOTE_ON 0x90
+#define MIDI_POLY_PRESSURE 0xA0
+#define MIDI_CONTROL_CHANGE 0xB0
+#define MIDI_PROGRAM_CHANGE 0xC0
+#define MIDI_CHANNEL_PRESSURE 0xD0
+#define MIDI_PITCH_BEND 0xE0
+
+// Controllers
+#define MIDI_CC_ALL_SOUND_OFF 120
+#define MIDI_CC_ALL_NOTES_OFF 123
+
+/**
+ * @brief Class for decoding MIDI messages for a single channel.
+ * 
+ * Handles running status, ignores system realtime bytes wherever they appear
+ * and skips system exclusive and system common messages. Never blocks, so
+ * bytes can be given to it as they arrive.
+ * 
+ */
+class MidiParser {
+    public:
+        /**
+         * @brief Construct a new Midi Parser object.
+         * 
+         * @param channel the channel to listen to (zero indexed).
+         */
+        MidiParser(const uint8_t channel) : m_channel(channel) {}
+
+        /**
+         * @brief Adds the next byte from the stream.
+         * 
+         * @param byte the byte received.
+         * @return true if a complete message for this channel has been
+         *         received. Use type(), data1() and data2() to get it.
+         * @return false if more bytes are needed or the message was ignored.
+         */
+        bool parse(uint8_t byte) {
+            if (byte >= 0xf8) {
+                // System realtime. Can appear anywhere, even mid message.
+                return false;
+            }
+
+            if (byte & 0x80) {
+                // Status byte
+                m_count = 0;
+                if (byte < 0xf0) {
+                    // Channel message
+                    m_status = byte;
+                    uint8_t type = byte & 0xf0;
+                    m_needed = (type == MIDI_PROGRAM_CHANGE || type == MIDI_CHANNEL_PRESSURE) ? 1 : 2;
+                } else {
+                    // System exclusive or common. Cancels running status and
+                    // the data bytes are skipped.
+                    m_status = 0;
+                }
+                return false;
+            }
+
+            // Data byte
+            if (!m_status) {
+                // Not in a channel message (sysex, system common or no status
+                // received yet).
+                return false;
+            }
+            m_data[m_count++] = byte;
+            if (m_count == m_needed) {
+                // Message finished. Keep the status for running status.
+                m_count = 0;
+                return (m_status & 0x0f) == m_channel;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Returns the type of the last message (MIDI_NOTE_ON, ...).
+         * 
+         * @return uint8_t 
+         */
+        inline uint8_t type() const {
+            return m_status & 0xf0;
+        }
+
+        inline uint8_t data1() const {
+            return m_data[0];
+        }
+
+        inline uint8_t data2() const {
+            return m_data[1];
+        }
+
+    private:
+        const uint8_t m_channel;
+        uint8_t m_status = 0; // 0 if not in a channel message.
+        uint8_t m_needed;
+        uint8_t m_count = 0;
+        uint8_t m_data[2];
+};
+
+/**
+ * @brief Keeps track of the notes held down in the order they were pressed
+ * so that the most recent can be played (last note priority).
+ * 
+ * @tparam CAPACITY the maximum number of notes to remember. When full, the
+ *                  oldest note is forgotten.
+ */
+template <uint8_t CAPACITY>
+class NoteStack {
+    public:
+        /**
+         * @brief Adds a note as the most recent.
+         * 
+         * @param note the MIDI note number.
+         */
+        void push(uint8_t note) {
+            remove(note);
+            if (m_count == CAPACITY) {
+                // Forget the oldest note.
+                m_removeAt(0);
+            }
+            m_notes[m_count++] = note;
+        }
+
+        /**
+         * @brief Removes a note if it is in the stack.
+         * 
+         * @param note the MIDI note number.
+         */
+        void remove(uint8_t note) {
+            for (uint8_t i = 0; i < m_count; i++) {
+                if (m_notes[i] == note) {
+                    m_removeAt(i);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the most recent note held down. The stack must not be
+         * empty.
+         * 
+         * @return uint8_t 
+         */
+        inline uint8_t top() const {
+            return m_notes[m_count - 1];
+        }
+
+        inline bool isEmpty() const {
+            return m_count == 0;
+        }
+
+        inline void clear() {
+            m_count = 0;
+        }
+
+    private:
+        void m_removeAt(uint8_t index) {
+            m_count--;
+            for (uint8_t i = index; i < m_count; i++) {
+                m_notes[i] = m_notes[i + 1];
+            }
+        }
+
+        uint8_t m_notes[CAPACITY];
+        uint8_t m_count = 0;
+};
\ No newline at end of file
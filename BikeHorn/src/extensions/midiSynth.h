@@ -6,10 +6,15 @@
  * extension for maintainability.
  * 
  * Written by Jotham Gates
- * Last modified 01/11/2022
+ * Last modified 18/10/2026
  */
 #pragma once
 #include "extensionsManager.h"
+#include "midiParser.h"
+#include "midiVoice.h"
+
+#define MIDI_NOTE_STACK 8 // Number of held notes to remember for last note priority.
+#define MIDI_NO_NOTE 0xff
 
 class MidiSynthExtension: public Extension {
     public:
@@ -22,57 +27,89 @@ class MidiSynthExtension: public Extension {
 
 
     private:
-        /** Mode for a midi synth. This is blocking and will only exit on reset or if the horn button is pressed. */
+        /**
+         * Mode for a midi synth. This is blocking and will only exit on reset or if the horn button is pressed.
+         * 
+         * The serial receive interrupt buffers the incoming bytes. Each time around the loop, everything in the
+         * buffer is parsed and then the sound is updated once for the most recent note still held down, so a burst
+         * of messages doesn't delay the sound by more than it takes to parse them.
+         * 
+         * Changing between held notes, pitch bend, portamento and modulation all change the frequency without
+         * restarting timer 1 (see MidiVoice).
+         */
         void midiSynth() {
             // Flashing lights to warn of being in this mode
             digitalWrite(LED_BUILTIN, LOW);
             digitalWrite(LED_EXTERNAL, HIGH);
+            ClockManager::fast(); // Before calculating the baud rate
+            Serial.begin(MIDI_BAUD);
 
             startBoost();
-            uint8_t currentNote;
+            MidiParser parser(MIDI_CHANNEL);
+            NoteStack<MIDI_NOTE_STACK> notes;
+            MidiVoice voice(piezo);
+            uint8_t currentNote = MIDI_NO_NOTE;
 
             while(!IS_PRESSED(BUTTON_HORN)) {
                 WATCHDOG_RESET;
-                uint8_t incomingNote; // The next byte to be read off the serial buffer.
-                uint8_t midiPitch; // The MIDI note number.
-                uint8_t midiVelocity; //The velocity of the note.
 
-                incomingNote = getByte();
-                // Analyse the byte. The byte at this stage should be a status byte. If it isn't, the byte is ignored.
-                switch (incomingNote) {
-                    case B10010000 | MIDI_CHANNEL: // Note on
-                    midiPitch = getByte();
-                    if(midiPitch != -1) {
-                        midiVelocity = getByte();
-                        if(midiVelocity != -1) {
-                            piezo.playMidiNote(midiPitch); // This will handle the conversion into note and octave.
-                            digitalWrite(LED_BUILTIN, HIGH);
-                            digitalWrite(LED_EXTERNAL, LOW);
-                            currentNote = midiPitch;
-                        }
+                // Process everything received so far
+                while (Serial.available()) {
+                    if (parser.parse(Serial.read())) {
+                        m_handleMessage(parser, notes, voice);
                     }
-                    break;
+                }
 
-                    case B10000000 | MIDI_CHANNEL: // Note off
-                    midiPitch = getByte();
-                    if(midiPitch == currentNote) {
-                        piezo.stopSound();
+                // Play the most recent note held down
+                uint8_t note = notes.isEmpty() ? MIDI_NO_NOTE : notes.top();
+                if (note != currentNote) {
+                    currentNote = note;
+                    if (note != MIDI_NO_NOTE) {
+                        voice.play(note);
+                        digitalWrite(LED_BUILTIN, HIGH);
+                        digitalWrite(LED_EXTERNAL, LOW);
+                    } else {
+                        voice.stop();
                         digitalWrite(LED_BUILTIN, LOW);
                         digitalWrite(LED_EXTERNAL, HIGH);
                     }
-                    break;
                 }
+
+                // Glides and vibrato
+                voice.update();
             }
             piezo.stopSound();
             digitalWrite(LED_BUILTIN, LOW);
             digitalWrite(LED_EXTERNAL, LOW);
+            Serial.begin(SERIAL_BAUD);
         }
 
-        /** Wait for an incoming note and return the note. */
-        byte getByte() {
-            while (!Serial.available() && !IS_PRESSED(BUTTON_HORN)) {
-                WATCHDOG_RESET;
-            } //Wait while there are no bytes to read in the buffer.
-            return Serial.read();
+        /** Updates the held notes and controllers from a message. */
+        void m_handleMessage(const MidiParser& parser, NoteStack<MIDI_NOTE_STACK>& notes, MidiVoice& voice) {
+            switch (parser.type()) {
+                case MIDI_NOTE_ON:
+                    if (parser.data2()) {
+                        notes.push(parser.data1());
+                        break;
+                    }
+                    // Note on with a velocity of 0 is note off.
+                    // Fall through
+
+                case MIDI_NOTE_OFF:
+                    notes.remove(parser.data1());
+                    break;
+
+                case MIDI_CONTROL_CHANGE:
+                    if (parser.data1() == MIDI_CC_ALL_NOTES_OFF || parser.data1() == MIDI_CC_ALL_SOUND_OFF) {
+                        notes.clear();
+                    } else {
+                        voice.controlChange(parser.data1(), parser.data2());
+                    }
+                    break;
+
+                case MIDI_PITCH_BEND:
+                    voice.bend(parser.data1(), parser.data2());
+                    break;
+            }
         }
 };
\ No newline at end of file
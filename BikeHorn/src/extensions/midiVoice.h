@@ -0,0 +1,221 @@
+/** midiVoice.h
+ * Controls the pitch of the piezo in MIDI synth mode, including pitch bend,
+ * portamento (glide) and modulation (vibrato).
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "midiParser.h"
+
+#define MIDI_CONTROL_INTERVAL 4000 // Time between pitch updates in us.
+#define MIDI_BEND_RANGE 2 // Semitones up or down at full pitch bend.
+#define MIDI_GLIDE_RATE 1024 // Glide speed in 1/256 semitones per update with a portamento time of 0. Divided by (time + 1).
+#define MIDI_VIBRATO_DEPTH 128 // Depth in 1/256 semitones either side at full modulation.
+#define MIDI_VIBRATO_STEP 1573 // Added to the 16 bit vibrato phase each update. 1573 is 6Hz at 4ms.
+#define MIDI_LOWEST_NOTE 24 // Timer 1 can't go much lower than this.
+
+// Controllers
+#define MIDI_CC_MODULATION 1
+#define MIDI_CC_PORTAMENTO_TIME 5
+#define MIDI_CC_PORTAMENTO 65
+#define MIDI_CC_RESET_CONTROLLERS 121
+
+/**
+ * @brief Timer 1 top values for notes MIDI_LOWEST_NOTE to MIDI_LOWEST_NOTE + 12.
+ * Higher octaves are found by halving.
+ * 
+ */
+const uint16_t midiPeriods[] PROGMEM = {
+    (uint16_t)(F_CPU / 8 / 32.7032),
+    (uint16_t)(F_CPU / 8 / 34.6478),
+    (uint16_t)(F_CPU / 8 / 36.7081),
+    (uint16_t)(F_CPU / 8 / 38.8909),
+    (uint16_t)(F_CPU / 8 / 41.2034),
+    (uint16_t)(F_CPU / 8 / 43.6535),
+    (uint16_t)(F_CPU / 8 / 46.2493),
+    (uint16_t)(F_CPU / 8 / 48.9994),
+    (uint16_t)(F_CPU / 8 / 51.9131),
+    (uint16_t)(F_CPU / 8 / 55.0000),
+    (uint16_t)(F_CPU / 8 / 58.2705),
+    (uint16_t)(F_CPU / 8 / 61.7354),
+    (uint16_t)(F_CPU / 8 / 65.4064)
+};
+
+/**
+ * @brief Class for a single voice with continuous pitch.
+ * 
+ * Pitches are stored in 1/256 of a semitone (MIDI note number << 8). Once a
+ * note is playing, the pitch is only ever changed through
+ * BikeHornSound::changeTop(), which updates timer 1 from the overflow
+ * interrupt, so the timer is never restarted or glitched part way through a
+ * cycle. Glides and vibrato are updated every MIDI_CONTROL_INTERVAL.
+ * 
+ */
+class MidiVoice {
+    public:
+        MidiVoice(BikeHornSound& sound) : m_sound(sound) {
+            resetControllers();
+        }
+
+        /**
+         * @brief Starts playing or moves to a new note.
+         * 
+         * If a note is already playing, this changes to the new note without
+         * restarting the timer (gliding if portamento is on).
+         * 
+         * @param note MIDI note number.
+         */
+        void play(uint8_t note) {
+            m_target = (uint16_t)note << 8;
+            if (!m_sound.isPlaying()) {
+                // Starting from silence
+                m_current = m_target;
+                m_phase = 0;
+                m_lastTop = m_top();
+                m_sound.playTop(m_lastTop);
+                m_lastUpdate = micros();
+            } else {
+                if (!m_portamento) {
+                    m_current = m_target;
+                }
+                // Update straight away so the note doesn't wait for the next
+                // control update.
+                m_apply();
+            }
+        }
+
+        /**
+         * @brief Stops the sound.
+         * 
+         */
+        void stop() {
+            m_sound.stopSound();
+        }
+
+        /**
+         * @brief Sets the pitch bend.
+         * 
+         * @param lsb the first data byte of the message.
+         * @param msb the second data byte of the message.
+         */
+        void bend(uint8_t lsb, uint8_t msb) {
+            int16_t value = ((uint16_t)msb << 7 | lsb) - 8192;
+            m_bend = (int32_t)value * MIDI_BEND_RANGE / 32; // 8192 is MIDI_BEND_RANGE * 256
+        }
+
+        /**
+         * @brief Handles a control change message.
+         * 
+         * @param controller the controller number.
+         * @param value the new value.
+         */
+        void controlChange(uint8_t controller, uint8_t value) {
+            switch (controller) {
+                case MIDI_CC_MODULATION:
+                    m_modulation = value;
+                    break;
+                case MIDI_CC_PORTAMENTO_TIME:
+                    m_glideStep = MIDI_GLIDE_RATE / (value + 1);
+                    break;
+                case MIDI_CC_PORTAMENTO:
+                    m_portamento = value >= 64;
+                    break;
+                case MIDI_CC_RESET_CONTROLLERS:
+                    resetControllers();
+                    break;
+            }
+        }
+
+        /**
+         * @brief Sets pitch bend, modulation and portamento back to default.
+         * 
+         */
+        void resetControllers() {
+            m_bend = 0;
+            m_modulation = 0;
+            m_portamento = false;
+            m_glideStep = MIDI_GLIDE_RATE;
+        }
+
+        /**
+         * @brief Updates glides and vibrato. Call as often as possible.
+         * 
+         */
+        void update() {
+            uint32_t time = micros();
+            if (m_sound.isPlaying() && time - m_lastUpdate >= MIDI_CONTROL_INTERVAL) {
+                m_lastUpdate += MIDI_CONTROL_INTERVAL;
+                if (time - m_lastUpdate >= MIDI_CONTROL_INTERVAL) {
+                    // Fell behind. Don't try to catch up.
+                    m_lastUpdate = time;
+                }
+
+                // Glide towards the target
+                if (m_current < m_target) {
+                    m_current = m_target - m_current > m_glideStep ? m_current + m_glideStep : m_target;
+                } else if (m_current > m_target) {
+                    m_current = m_current - m_target > m_glideStep ? m_current - m_glideStep : m_target;
+                }
+                m_phase += MIDI_VIBRATO_STEP;
+                m_apply();
+            }
+        }
+
+    private:
+        /**
+         * @brief Updates timer 1 if the pitch has changed.
+         * 
+         */
+        void m_apply() {
+            uint16_t top = m_top();
+            if (top != m_lastTop) {
+                m_lastTop = top;
+                m_sound.changeTop(top);
+            }
+        }
+
+        /**
+         * @brief Works out the timer 1 top value for the current pitch,
+         * including bend and vibrato.
+         * 
+         * @return uint16_t 
+         */
+        uint16_t m_top() const {
+            int32_t pitch = (int32_t)m_current + m_bend;
+            if (m_modulation) {
+                // Triangle wave from -16384 to 16383
+                int16_t triangle = (m_phase < 32768 ? m_phase : 65535 - m_phase) - 16384;
+                pitch += (int32_t)triangle * m_modulation * MIDI_VIBRATO_DEPTH / (127L * 16384);
+            }
+
+            // Limit to what can be played
+            if (pitch < (MIDI_LOWEST_NOTE << 8)) {
+                pitch = MIDI_LOWEST_NOTE << 8;
+            } else if (pitch > (127L << 8)) {
+                pitch = 127L << 8;
+            }
+
+            // Interpolate between semitones and shift for the octave
+            uint8_t fraction = pitch & 0xff;
+            uint8_t note = (pitch >> 8) - MIDI_LOWEST_NOTE;
+            uint8_t octave = note / 12;
+            uint8_t semitone = note % 12;
+            uint16_t lower = pgm_read_word(&midiPeriods[semitone]);
+            uint16_t upper = pgm_read_word(&midiPeriods[semitone + 1]);
+            uint16_t top = lower - (((uint32_t)(lower - upper) * fraction) >> 8);
+            return top >> octave;
+        }
+
+        BikeHornSound& m_sound;
+        uint16_t m_target; // Pitch of the note being played.
+        uint16_t m_current; // Pitch glided to so far.
+        int16_t m_bend;
+        uint8_t m_modulation;
+        bool m_portamento;
+        uint16_t m_glideStep;
+        uint16_t m_phase; // Vibrato phase.
+        uint16_t m_lastTop;
+        uint32_t m_lastUpdate;
+};
\ No newline at end of file
@@ -0,0 +1,37 @@
+/** profileMode.h
+ * Adds a menu item to change between the output profiles (outputProfiles in
+ * soundGeneration.h) to trade loudness for battery life. The selected profile
+ * is saved to EEPROM.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "extensionsManager.h"
+
+class ProfileExtension: public Extension {
+    public:
+        ProfileExtension() {
+            menuActions.length = 1;
+            menuActions.array = (MenuItem*)malloc(sizeof(MenuItem));
+            menuActions.array[0] = (MenuItem)&ProfileExtension::nextProfile;
+        }
+
+    private:
+        /**
+         * @brief Moves to the next output profile. Profile 0 is the loudest.
+         * 
+         */
+        void nextProfile() {
+            uint8_t profile = piezo.getProfile() + 1;
+            if (profile == OUTPUT_PROFILES) {
+                profile = 0;
+            }
+            tune.stop(); // In case the menu beep is still going
+            piezo.setProfile(profile);
+            Serial.print(F("Output profile "));
+            Serial.println(profile);
+            uiBeep(const_cast<uint16_t*>(beeps::acknowledge)); // Played with the new profile
+        }
+};
\ No newline at end of file
@@ -0,0 +1,29 @@
+/** ramReport.h
+ * Adds a menu item for printing how much RAM is used, including the deepest
+ * the stack has been since the horn started.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "extensionsManager.h"
+#include "../ramDebug.h"
+
+class RamReportExtension : public Extension {
+    public:
+        RamReportExtension() {
+            menuActions.length = 1;
+            menuActions.array = (MenuItem*)malloc(sizeof(MenuItem));
+            menuActions.array[0] = (MenuItem)&RamReportExtension::report;
+        }
+
+        void onStart() {
+            printRamUsage();
+        }
+
+    private:
+        void report() {
+            printRamUsage();
+        }
+};
\ No newline at end of file
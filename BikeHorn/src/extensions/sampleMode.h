@@ -0,0 +1,47 @@
+/** sampleMode.h
+ * Adds a menu item for playing the recorded sounds in samples.h. Each time it
+ * is selected, the next sample is played.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "extensionsManager.h"
+#include "../../samples.h"
+
+class SampleExtension: public Extension {
+    public:
+        SampleExtension() {
+            menuActions.length = 1;
+            menuActions.array = (MenuItem*)malloc(sizeof(MenuItem));
+            menuActions.array[0] = (MenuItem)&SampleExtension::playSample;
+        }
+
+    private:
+        /**
+         * @brief Plays the next sample and waits for it to finish.
+         * 
+         */
+        void playSample() {
+            Serial.print(F("Playing sample "));
+            Serial.println(s_next);
+            tune.stop();
+            startBoost();
+            SamplePlayer::play((const Sample*)pgm_read_ptr(&samples[s_next]));
+            while (SamplePlayer::isPlaying()) {
+                WATCHDOG_RESET;
+            }
+            SamplePlayer::stop();
+
+            s_next++;
+            if (s_next == sampleCount) {
+                s_next = 0;
+            }
+            revertToTune();
+        }
+
+        static uint8_t s_next;
+};
+
+uint8_t SampleExtension::s_next = 0;
\ No newline at end of file
@@ -0,0 +1,25 @@
+/** traceDump.h
+ * Adds a menu item for sending the trace events over serial.
+ * See Documentation/Tracing.md for more info.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "extensionsManager.h"
+#include "../trace.h"
+
+class TraceDumpExtension : public Extension {
+    public:
+        TraceDumpExtension() {
+            menuActions.length = 1;
+            menuActions.array = (MenuItem*)malloc(sizeof(MenuItem));
+            menuActions.array[0] = (MenuItem)&TraceDumpExtension::dump;
+        }
+
+    private:
+        void dump() {
+            Trace::dump();
+        }
+};
\ No newline at end of file
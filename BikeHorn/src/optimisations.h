@@ -2,9 +2,10 @@
  * Configurations and tuning for individual horns.
  * 
  * Written by Jotham Gates.
- * Last modified 11/01/2022
+ * Last modified 18/10/2026
  */
 #pragma once
+#include "recordStore.h"
 
 /**
  * @brief Class for a single linear function as part of a piecewise function (Used for mapping duty
@@ -15,21 +16,32 @@
 class LinearFunction {
     public:
         /**
-         * @brief Loads the parameters for the function from an address in EEPROM.
+         * @brief Loads the parameters for the function from a record that has been read into RAM.
          * 
-         * @param address The starting address. LinearFunction::EEPROM_BYTES contains the number of bytes that will be read.
+         * @param data The first byte of the function. LinearFunction::EEPROM_BYTES contains the number of bytes that will be read.
          * 
-         * Parameters are encoded in EEPROM from address in little endian format. i.e.
+         * Parameters are encoded in little endian format. i.e.
          * @code {.c++}
          * {[2 bytes for threshold], [1 byte for the multiplier], [2 bytes for the divisor], [3 bytes for the constant]}
          * @endcode
          * 
          */
-        void load(uint16_t address) {
-            m_threshold = m_readInt16(address);
-            m_multiplier = EEPROM.read(address + 2);
-            m_divisor = m_readInt16(address + 3);
-            m_constant = m_readInt24(address + 5);
+        void load(const uint8_t *data) {
+            m_threshold = m_readInt16(data);
+            m_multiplier = data[2];
+            m_divisor = m_readInt16(data + 3);
+            m_constant = m_readInt24(data + 5);
+        }
+
+        /**
+         * @brief Scales the output of the function. Done by increasing the divisor rather than reducing the
+         * multiplier as the multiplier is often small.
+         * 
+         * @param percent the percentage of the original output (1 to 100).
+         */
+        void scale(uint8_t percent) {
+            m_divisor = m_divisor * 100 / percent;
+            m_constant = m_constant * percent / 100;
         }
 
         /**
@@ -81,30 +93,39 @@ class LinearFunction {
         static const int EEPROM_BYTES = 8;
     private:
         /**
-         * @brief Reads an integer from eeprom (little endian - lowest byte first)
+         * @brief Reads an integer (little endian - lowest byte first)
          * 
-         * @param address the address of the first byte to read
-         * @return int16_t the value at that address
+         * @param data the first byte to read
+         * @return int16_t the value
          */
-        int16_t m_readInt16(uint16_t address) {
-            return EEPROM.read(address) | (EEPROM.read(address+1) << 8);
+        int16_t m_readInt16(const uint8_t *data) {
+            return data[0] | (data[1] << 8);
         }
-        int32_t m_readInt24(uint16_t address) {
-            return EEPROM.read(address) |
-                  (EEPROM.read(address+1) << 8) |
-                  (EEPROM.read(address+2) << 16);
+
+        /**
+         * @brief Reads a signed 24 bit integer (little endian - lowest byte first)
+         * 
+         * @param data the first byte to read
+         * @return int32_t the value
+         */
+        int32_t m_readInt24(const uint8_t *data) {
+            int32_t value = data[0] | ((uint16_t)data[1] << 8) | ((uint32_t)data[2] << 16);
+            if (value & 0x800000) {
+                value |= 0xff000000; // Negative
+            }
+            return value;
         }
         uint16_t m_threshold;
         int32_t m_constant;
         uint8_t m_multiplier;
-        int16_t m_divisor;
+        int32_t m_divisor; // Stored as 16 bits, but can grow when scaled.
 };
 
 /**
  * @brief Class for a piecewise function consiting of many linear functions.
  * 
- * The parameters are loaded from EEPROM memory. The first byte is the number of linear functions,
- * followed by that number of linear functions as described above. It is assumed that the smallest
+ * The parameters are loaded from a record in EEPROM (see recordStore.h). The first byte of the payload
+ * is the number of linear functions, followed by that number of linear functions as described above. It is assumed that the smallest
  * thresholds will be first, i.e.
  * @code {.language-id}
  * {[1 byte for number of functions], [8 bytes for function 1], [8 bytes for function 2], ...}
@@ -114,22 +135,29 @@ class LinearFunction {
 class PiecewiseLinear {
     public:
         /**
-         * @brief Initialises and loads the parameters from eeprom.
+         * @brief Initialises and loads the parameters from a record in eeprom.
+         * Can be called again to reload with a different scale.
          * 
-         * @param address the address of the first byte in eeprom.
+         * @param type the record to load.
+         * @param percent scales the output to this percentage of what was tuned (1 to 100).
          * 
-         * @returns true if the length and data is reasonable, false otherwise (potentially bad data)
+         * @returns true if the record is intact and the data is reasonable, false otherwise (missing or bad data)
          */
-        bool begin(uint16_t address) {
-            // Load first address, this has the number of points and allocate ram for each point
-            m_length = EEPROM.read(address);
+        bool begin(RecordType type, uint8_t percent = 100) {
+            // Read the whole record in one go. The first byte has the number of points.
+            uint8_t data[EEPROM_PIECEWISE_SIZE];
+            uint8_t size = RecordStore::read(type, data, sizeof(data));
+            m_length = size ? data[0] : 0;
             // Sanity checking
-            if(m_length != 0 && m_length <= EEPROM_PIECEWISE_MAX_LENGTH) {
-                m_functions = (LinearFunction *)malloc(m_length * sizeof(LinearFunction));
+            if(m_length != 0 && m_length <= EEPROM_PIECEWISE_MAX_LENGTH && size == 1 + m_length * LinearFunction::EEPROM_BYTES) {
+                m_functions = (LinearFunction *)realloc(m_functions, m_length * sizeof(LinearFunction));
 
-                // For each address (sizeof), create a LinearFunction object and fill it out
+                // For each function, create a LinearFunction object and fill it out
                 for(uint8_t i = 0; i < m_length; i++) {
-                    m_functions[i].load(i*LinearFunction::EEPROM_BYTES + address + 1);
+                    m_functions[i].load(&data[i*LinearFunction::EEPROM_BYTES + 1]);
+                    if(percent != 100) {
+                        m_functions[i].scale(percent);
+                    }
                 }
 
                 // Check of the thresholds are strictly increasing as another sanity check
@@ -142,7 +170,8 @@ class PiecewiseLinear {
                 // Successfully loaded with acceptable data
                 return true;
             } else {
-                // Something is wrong with the length
+                // Something is wrong with the record or the length
+                m_length = 0;
                 return false;
             }
             
@@ -214,6 +243,8 @@ class PiecewiseLinear {
          */
         void end() {
             free(m_functions);
+            m_functions = nullptr;
+            m_length = 0;
         }
     private:
         /**
@@ -226,6 +257,6 @@ class PiecewiseLinear {
                 Serial.write(' ');
             }
         }
-        LinearFunction *m_functions;
+        LinearFunction *m_functions = nullptr;
         uint8_t m_length = 0;
 };
\ No newline at end of file
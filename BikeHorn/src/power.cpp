@@ -0,0 +1,47 @@
+/** power.cpp
+ * See power.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include "power.h"
+
+uint8_t PowerManager::s_users[8];
+
+void PowerManager::begin() {
+    uint8_t oldSREG = SREG;
+    cli();
+    // init() in the Arduino core starts the ADC and timers 1 and 2 for analogRead() and analogWrite().
+    ADCSRA = 0;
+    TCCR1B = 0;
+    TCCR2B = 0;
+    PRR = bit(PRTWI) | bit(PRTIM2) | bit(PRTIM1) | bit(PRSPI) | bit(PRUSART0) | bit(PRADC);
+    memset(s_users, 0, sizeof(s_users));
+    SREG = oldSREG;
+}
+
+void PowerManager::acquire(PowerDomain domain) {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (s_users[domain]++ == 0) {
+        PRR &= ~bit(domain);
+    }
+    SREG = oldSREG;
+}
+
+void PowerManager::release(PowerDomain domain) {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (s_users[domain]) {
+        s_users[domain]--;
+    }
+    if (s_users[domain] == 0) {
+        if (domain == POWER_ADC) {
+            ADCSRA = 0; // Must be disabled before being switched off.
+        }
+        PRR |= bit(domain);
+    }
+    SREG = oldSREG;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/** power.h
+ * Keeps peripherals switched off in the power reduction register (PRR) unless
+ * something is using them.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief Peripherals that can be switched off. The values are the bits in PRR.
+ * Timer 0 is never switched off as millis() needs it.
+ * 
+ */
+enum PowerDomain : uint8_t {
+    POWER_ADC = PRADC,
+    POWER_USART = PRUSART0,
+    POWER_SPI = PRSPI, // Not used
+    POWER_TIMER1 = PRTIM1, // Piezo
+    POWER_TIMER2 = PRTIM2, // Boost stage
+    POWER_TWI = PRTWI // Not used
+};
+
+/**
+ * @brief Reference counts users of each peripheral and switches it off when
+ * the last one is finished with it.
+ * 
+ * While a peripheral is switched off, its registers can't be read or written,
+ * so check isOn() before reading them. Users should stop the peripheral before
+ * releasing it. The ADC is the exception, which is disabled here as it has to
+ * be disabled before it is switched off.
+ * 
+ * All methods are safe to call from interrupts.
+ * 
+ */
+class PowerManager {
+    public:
+        /**
+         * @brief Stops the peripherals the Arduino core starts and switches
+         * off everything except timer 0. Call at the start of setup().
+         * 
+         */
+        static void begin();
+
+        /**
+         * @brief Switches a peripheral on if it isn't already and adds a user.
+         * 
+         * @param domain the peripheral.
+         */
+        static void acquire(PowerDomain domain);
+
+        /**
+         * @brief Removes a user from a peripheral and switches it off if there
+         * are no users left. Releasing a peripheral with no users just makes
+         * sure it is switched off.
+         * 
+         * @param domain the peripheral.
+         */
+        static void release(PowerDomain domain);
+
+        /**
+         * @brief Returns true if a peripheral is switched on.
+         * 
+         * @param domain the peripheral.
+         */
+        static inline bool isOn(PowerDomain domain) {
+            return !(PRR & bit(domain));
+        }
+
+    private:
+        static uint8_t s_users[8]; // Indexed by bit in PRR.
+};
\ No newline at end of file
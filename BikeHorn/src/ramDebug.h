@@ -1,8 +1,11 @@
 /** ramDebug.h
  * Functions to print the amount of RAM free (dustance between the head and stack).
  * 
+ * On AVR, the free RAM is also painted at boot so that the deepest the stack
+ * has ever reached can be found later, and the heap can be summarised.
+ * 
  * Written by Jotham Gates, based off Adafruit examples.
- * Last modified 07/11/2022
+ * Last modified 18/10/2026
  */
 
 #pragma once
@@ -44,4 +47,105 @@ void debugRam(unsigned int lineNumber) {
   Serial.print(lineNumber);
   Serial.print(F(" RAM Left: "));
   Serial.println(freeRam());
-}
\ No newline at end of file
+}
+
+#ifdef __AVR__
+#define STACK_PAINT 0xc5 // Value unused RAM is filled with at boot.
+
+extern uint8_t _end; // End of the static variables (start of the heap).
+extern uint8_t __stack; // Top of RAM (start of the stack).
+extern uint8_t __data_start; // Start of the static variables.
+
+// Free list used by malloc() (see avr-libc's stdlib_private.h).
+struct __freelist {
+  size_t sz;
+  struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+/**
+ * @brief Fills all RAM after the static variables with STACK_PAINT.
+ * 
+ * This is run automatically from the .init3 section, which is after the stack
+ * pointer has been set up but before the static variables are initialised and
+ * anything has been called, so nothing on the stack can be overwritten. Do not
+ * call it.
+ */
+void paintStack() __attribute__((naked, used, section(".init3")));
+void paintStack() {
+  uint8_t *p = &_end;
+  while (p <= &__stack) {
+    *p = STACK_PAINT;
+    p++;
+  }
+}
+
+/**
+ * @brief Returns the current top of the heap.
+ * 
+ * @return uint8_t* the first byte after the heap.
+ */
+uint8_t *heapTop() {
+  return __brkval ? (uint8_t*)__brkval : (uint8_t*)__malloc_heap_start;
+}
+
+/**
+ * @brief Finds the lowest address the stack has reached since boot by looking
+ * for the first byte above the heap that is no longer STACK_PAINT.
+ * 
+ * If the heap has shrunk, memory it used is not painted, so this may
+ * overestimate the stack used. A stack variable that happens to be STACK_PAINT
+ * could make it underestimate it by a byte or two.
+ * 
+ * @return uint8_t* the lowest address used by the stack.
+ */
+uint8_t *stackLowest() {
+  uint8_t *p = heapTop();
+  while (p <= &__stack && *p == STACK_PAINT) {
+    p++;
+  }
+  return p;
+}
+
+/**
+ * @brief Returns the most stack that has been used since boot.
+ * 
+ * @return uint16_t the high water mark in bytes.
+ */
+uint16_t stackHighWater() {
+  return &__stack - stackLowest() + 1;
+}
+
+/**
+ * @brief Prints a summary of where the RAM is used.
+ * 
+ */
+void printRamUsage() {
+  uint16_t heapSize = heapTop() - (uint8_t*)__malloc_heap_start;
+  uint16_t heapFree = 0;
+  uint8_t freeBlocks = 0;
+  for (struct __freelist *block = __flp; block; block = block->nx) {
+    heapFree += block->sz + sizeof(size_t);
+    freeBlocks++;
+  }
+  Serial.print(F("RAM (bytes): "));
+  Serial.println(RAMEND - RAMSTART + 1);
+  Serial.print(F("Static: "));
+  Serial.println(&_end - &__data_start);
+  Serial.print(F("Heap: "));
+  Serial.print(heapSize);
+  Serial.print(F(", "));
+  Serial.print(heapFree);
+  Serial.print(F(" free in "));
+  Serial.print(freeBlocks);
+  Serial.println(F(" blocks"));
+  Serial.print(F("Stack now: "));
+  Serial.print((uint16_t)(RAMEND - SP));
+  Serial.print(F(", deepest: "));
+  Serial.println(stackHighWater());
+  Serial.print(F("Free now: "));
+  Serial.print(freeRam());
+  Serial.print(F(", least: "));
+  Serial.println(stackLowest() - heapTop());
+}
+#endif
\ No newline at end of file
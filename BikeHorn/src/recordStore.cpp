@@ -0,0 +1,71 @@
+/** recordStore.cpp
+ * See recordStore.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include "recordStore.h"
+#include "trace.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+// Where each record goes, in the same order as RecordType.
+const RecordSlot recordSlots[RECORD_COUNT] PROGMEM = {
+    {EEPROM_TIMER1_PIECEWISE, 1, EEPROM_PIECEWISE_SIZE},
+    {EEPROM_TIMER2_PIECEWISE, 1, EEPROM_PIECEWISE_SIZE},
+    {EEPROM_ACCEL_SETTLE, 1, 1},
+    {EEPROM_OUTPUT_PROFILE, 1, 1}
+};
+
+uint8_t RecordStore::read(RecordType type, void *payload, uint8_t capacity) {
+    RecordSlot slot = m_slot(type);
+    uint8_t header[RECORD_HEADER_SIZE];
+    eeprom_read_block(header, (const void*)slot.address, RECORD_HEADER_SIZE);
+    uint8_t length = header[2];
+    if (header[0] != type || header[1] != slot.version || length == 0 || length > slot.capacity || length > capacity) {
+        // Missing (erased EEPROM fails the type check), from another version or not going to fit.
+        return 0;
+    }
+
+    eeprom_read_block(payload, (const void*)(slot.address + RECORD_HEADER_SIZE), length);
+    uint16_t crc;
+    eeprom_read_block(&crc, (const void*)(slot.address + RECORD_HEADER_SIZE + length), RECORD_CRC_SIZE);
+    if (crc != m_crc(header, (const uint8_t*)payload)) {
+        return 0;
+    }
+    return length;
+}
+
+bool RecordStore::write(RecordType type, const void *payload, uint8_t length) {
+    RecordSlot slot = m_slot(type);
+    if (length == 0 || length > slot.capacity) {
+        return false;
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE] = {type, slot.version, length};
+    uint16_t crc = m_crc(header, (const uint8_t*)payload);
+    TRACE(TRACE_EEPROM_WRITE, slot.address);
+    eeprom_update_block(header, (void*)slot.address, RECORD_HEADER_SIZE);
+    eeprom_update_block(payload, (void*)(slot.address + RECORD_HEADER_SIZE), length);
+    eeprom_update_block(&crc, (void*)(slot.address + RECORD_HEADER_SIZE + length), RECORD_CRC_SIZE);
+    return true;
+}
+
+RecordSlot RecordStore::m_slot(RecordType type) {
+    RecordSlot slot;
+    memcpy_P(&slot, &recordSlots[type], sizeof(RecordSlot));
+    return slot;
+}
+
+uint16_t RecordStore::m_crc(const uint8_t *header, const uint8_t *payload) {
+    uint16_t crc = 0;
+    for (uint8_t i = 0; i < RECORD_HEADER_SIZE; i++) {
+        crc = _crc_xmodem_update(crc, header[i]);
+    }
+    for (uint8_t i = 0; i < header[2]; i++) {
+        crc = _crc_xmodem_update(crc, payload[i]);
+    }
+    return crc;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+/** recordStore.h
+ * Typed, versioned and CRC checked records in EEPROM.
+ * 
+ * Each record is stored at a fixed address (see the EEPROM settings in
+ * defines.h) as
+ * @code {.c++}
+ * {[1 byte type], [1 byte version], [1 byte payload length], [payload], [2 byte CRC]}
+ * @endcode
+ * The CRC is CRC-16/XMODEM over the type, version, length and payload, stored
+ * little endian (the same CRC as the optimiser sketch's frames). A record that
+ * is missing, corrupt or from a different version is rejected as a whole.
+ * 
+ * Each record is read into RAM in one go (when the horn starts or when first
+ * needed) and kept there by whatever uses it, which also updates its copy when
+ * writing. There is no cache in RecordStore itself as the piecewise functions
+ * are already kept in RAM by PiecewiseLinear and a second copy would cost
+ * around 170 of the 2kB of RAM. Writing only changes the bytes that are
+ * different.
+ * 
+ * Tuning/BikeHornOptimiser.py writes the piecewise function records, so the
+ * types, versions and addresses need to match RECORD_* there.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include <Arduino.h>
+#include "../defines.h"
+
+#define RECORD_HEADER_SIZE 3 // Type, version and length.
+#define RECORD_CRC_SIZE 2
+
+static_assert(RECORD_HEADER_SIZE + RECORD_CRC_SIZE == EEPROM_RECORD_OVERHEAD, "EEPROM_RECORD_OVERHEAD is wrong");
+
+/**
+ * @brief Record types. These are also the index into recordSlots.
+ * 
+ */
+enum RecordType : uint8_t {
+    RECORD_TIMER1_PIECEWISE, // Piezo duty piecewise function (see optimisations.h).
+    RECORD_TIMER2_PIECEWISE, // Boost duty piecewise function (see optimisations.h).
+    RECORD_ACCEL_SETTLE,     // period_t to wait for the accelerometer to settle (1 byte).
+    RECORD_OUTPUT_PROFILE,   // Index of the selected output profile (1 byte, see soundGeneration.h).
+    RECORD_COUNT
+};
+
+/**
+ * @brief Where a record is stored and what it should look like. Stored in
+ * PROGMEM.
+ * 
+ */
+struct RecordSlot {
+    uint16_t address; // First byte of the header.
+    uint8_t version; // Version of the payload format. Increase when the format changes.
+    uint8_t capacity; // Longest payload that fits.
+};
+
+/**
+ * @brief Class for reading and writing records.
+ * 
+ */
+class RecordStore {
+    public:
+        /**
+         * @brief Reads a record into RAM and checks it.
+         * 
+         * @param type the record to read.
+         * @param payload where to put the payload.
+         * @param capacity the size of payload in bytes.
+         * @return uint8_t the length of the payload, or 0 if the record is
+         *                 missing, corrupt, a different version or too long.
+         */
+        static uint8_t read(RecordType type, void *payload, uint8_t capacity);
+
+        /**
+         * @brief Writes a record if it has changed. Blocks for 3.3ms for each
+         * byte that is different.
+         * 
+         * @param type the record to write.
+         * @param payload the payload.
+         * @param length the length of the payload in bytes.
+         * @return true if written (or unchanged), false if too long.
+         */
+        static bool write(RecordType type, const void *payload, uint8_t length);
+
+    private:
+        /**
+         * @brief Gets the slot for a record.
+         * 
+         * @param type the record.
+         * @return RecordSlot where it is stored.
+         */
+        static RecordSlot m_slot(RecordType type);
+
+        /**
+         * @brief Calculates the CRC of the header and payload.
+         * 
+         * @param header the header.
+         * @param payload the payload.
+         * @return uint16_t the CRC.
+         */
+        static uint16_t m_crc(const uint8_t *header, const uint8_t *payload);
+};
\ No newline at end of file
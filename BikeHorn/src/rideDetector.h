@@ -0,0 +1,177 @@
+/** rideDetector.h
+ * Uses the accelerometer to tell if the bike is being ridden or is parked
+ * while the horn is asleep.
+ * 
+ * While riding, the horn idles instead of powering down with the boost stage
+ * kept warm, so the first note plays as quickly as possible. Once parked, it
+ * powers down between checks, then stops checking altogether after a while.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "boost.h"
+#include "power.h"
+#include "clock.h"
+
+#ifndef ACCEL_INSTALLED
+#error "Ride detection needs an accelerometer (ACCEL_INSTALLED)"
+#endif
+
+/**
+ * @brief Classifies riding and parked from how much the accelerometer moves
+ * between samples and sleeps accordingly.
+ * 
+ * Each sample that moved more than RIDE_MOTION_THRESHOLD adds
+ * RIDE_SCORE_MOVED to a score (up to RIDE_SCORE_MAX) and each quiet one takes
+ * 1 off. The horn is riding once the score reaches RIDE_SCORE_RIDING and stays
+ * riding until it gets back to 0, so stopping at the lights does not count as
+ * being parked.
+ * 
+ */
+class RideDetector {
+    public:
+        /**
+         * @brief Sleeps until a button is pressed, checking the accelerometer
+         * in between. Timed wakes only take a sample and go back to sleep, so
+         * the rest of the horn does not wake up. Call with the GPIO already
+         * asleep and the button interrupts enabled.
+         * 
+         */
+        void sleep() {
+            // Read here rather than in the constructor (run during static
+            // initialisation) so that recalibrating works without a restart.
+            period_t settlePeriod = StateSleep::settlePeriod();
+            while (true) {
+                if (m_riding) {
+                    m_warm();
+                } else if (BoostManager::isRunning()) {
+                    BoostManager::setKeepWarm(false);
+                    BoostManager::stop(); // Can't power down with it running
+                }
+                m_sleep(m_riding ? RIDE_SAMPLE_PERIOD : (m_quietSamples < RIDE_DEEP_SLEEP_SAMPLES ? RIDE_PARKED_PERIOD : SLEEP_FOREVER));
+                if (wakePin != PRESSED_NONE) {
+                    break;
+                }
+                m_sample(settlePeriod);
+            }
+
+            // Woken by a button
+            m_quietSamples = 0;
+            if (wakePin == PRESSED_HORN) {
+                // Probably riding. Stay warm for the next press.
+                if (m_score < RIDE_SCORE_RIDING) {
+                    m_score = RIDE_SCORE_RIDING;
+                }
+                m_riding = true;
+            } else {
+                // Could be going into the menu (and the burgler alarm), which powers down with the boost off.
+                BoostManager::setKeepWarm(false);
+            }
+        }
+
+        /**
+         * @brief Returns true if the bike is thought to be being ridden.
+         * 
+         */
+        inline bool isRiding() const {
+            return m_riding;
+        }
+
+    private:
+        /**
+         * @brief Starts the boost stage if needed and waits for it to finish
+         * soft starting, then leaves it at IDLE_DUTY.
+         * 
+         */
+        void m_warm() {
+            if (!BoostManager::isKeptWarm()) {
+                BoostManager::setKeepWarm(true);
+                while (BoostManager::isSoftStarting()) {
+                    // Only a few ms. Timer 0 is stopped while idling, so the soft start has to finish first.
+                }
+                BoostManager::idle();
+            }
+        }
+
+        /**
+         * @brief Sleeps as deeply as possible. Idles while the boost stage is
+         * running as it needs the IO clock, otherwise powers down.
+         * 
+         * @param period how long to sleep for.
+         */
+        void m_sleep(period_t period) {
+            if (BoostManager::isRunning()) {
+                // Serial and timer 1 were switched off in PRR by sleepGPIO(), so they are passed as ON here to
+                // leave them alone (OFF would switch them back on in PRR when waking up, behind the
+                // PowerManager's back).
+                LowPower.idle(period, ADC_ON, TIMER2_ON, TIMER1_ON, TIMER0_OFF, SPI_ON, USART0_ON, TWI_ON);
+            } else {
+                LowPower.powerDown(period, ADC_OFF, BOD_OFF);
+            }
+        }
+
+        /**
+         * @brief Turns the accelerometer on, reads it and updates the score.
+         * The first sample only gives the next one something to compare to.
+         * 
+         * @param settlePeriod how long the accelerometer takes to settle.
+         */
+        void m_sample(period_t settlePeriod) {
+            pinMode(ACCEL_POWER_PIN, OUTPUT);
+            digitalWrite(ACCEL_POWER_PIN, HIGH);
+            m_sleep(settlePeriod);
+
+            if (wakePin == PRESSED_NONE) {
+                PowerManager::acquire(POWER_ADC);
+                ADCSRA = bit(ADEN) | ClockManager::adcPrescaler();
+                const uint8_t pins[3] = {ACCEL_X_PIN, ACCEL_Y_PIN, ACCEL_Z_PIN};
+                uint16_t motion = 0;
+                for (uint8_t i = 0; i < 3; i++) {
+                    int16_t reading = analogRead(pins[i]);
+                    int16_t change = reading - m_previous[i];
+                    motion += abs(change);
+                    m_previous[i] = reading;
+                }
+                PowerManager::release(POWER_ADC);
+                if (m_primed) {
+                    m_update(motion > RIDE_MOTION_THRESHOLD);
+                }
+                m_primed = true;
+            }
+
+            digitalWrite(ACCEL_POWER_PIN, LOW);
+            pinMode(ACCEL_POWER_PIN, INPUT);
+        }
+
+        /**
+         * @brief Updates the score and whether the bike is being ridden.
+         * 
+         * @param moved true if the last sample moved.
+         */
+        void m_update(bool moved) {
+            if (moved) {
+                m_score = m_score > RIDE_SCORE_MAX - RIDE_SCORE_MOVED ? RIDE_SCORE_MAX : m_score + RIDE_SCORE_MOVED;
+                m_quietSamples = 0;
+            } else {
+                if (m_score) {
+                    m_score--;
+                }
+                if (m_quietSamples != 255) {
+                    m_quietSamples++;
+                }
+            }
+
+            if (m_riding ? m_score == 0 : m_score >= RIDE_SCORE_RIDING) {
+                m_riding = !m_riding;
+                m_quietSamples = 0;
+            }
+        }
+
+        int16_t m_previous[3] = {0, 0, 0};
+        bool m_primed = false; // m_previous holds a reading.
+        uint8_t m_score = 0;
+        uint8_t m_quietSamples = 0; // Quiet samples in a row, for deciding when to stop sampling.
+        bool m_riding = false;
+};
\ No newline at end of file
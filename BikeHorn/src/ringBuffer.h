@@ -0,0 +1,94 @@
+/** ringBuffer.h
+ * A small fixed size FIFO ring buffer that does not use the heap.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+
+/**
+ * @brief Fixed capacity first in, first out buffer stored inline in the
+ * object.
+ * 
+ * The read and write indices are free running and masked on each access, so
+ * the capacity must be a power of 2 and no more than 128 items.
+ * 
+ * @tparam Type the type of item to store.
+ * @tparam CAPACITY the maximum number of items.
+ */
+template <typename Type, uint8_t CAPACITY>
+class RingBuffer {
+    static_assert(CAPACITY != 0 && (CAPACITY & (CAPACITY - 1)) == 0, "RingBuffer capacity must be a power of 2");
+    static_assert(CAPACITY <= 128, "RingBuffer capacity must be 128 or less");
+
+    public:
+        /**
+         * @brief Adds an item to the end of the buffer. If the buffer is full,
+         * the oldest item is overwritten.
+         * 
+         * @param value the item to add.
+         */
+        inline void push(Type value) {
+            if (isFull()) {
+                m_tail++;
+            }
+            m_data[m_head & MASK] = value;
+            m_head++;
+        }
+
+        /**
+         * @brief Removes and returns the oldest item. The buffer must not be
+         * empty.
+         * 
+         * @return Type the oldest item.
+         */
+        inline Type pop() {
+            Type value = m_data[m_tail & MASK];
+            m_tail++;
+            return value;
+        }
+
+        /**
+         * @brief Returns an item without removing it, counting back from the
+         * newest. The index must be less than count().
+         * 
+         * @param index 0 for the newest item, 1 for the one before, ...
+         * @return Type the item.
+         */
+        inline Type peekNewest(uint8_t index) const {
+            return m_data[(uint8_t)(m_head - 1 - index) & MASK];
+        }
+
+        /**
+         * @brief Returns the number of items in the buffer.
+         * 
+         * @return uint8_t
+         */
+        inline uint8_t count() const {
+            return m_head - m_tail;
+        }
+
+        inline bool isEmpty() const {
+            return m_head == m_tail;
+        }
+
+        inline bool isFull() const {
+            return count() == CAPACITY;
+        }
+
+        /**
+         * @brief Empties the buffer.
+         * 
+         */
+        inline void clear() {
+            m_head = 0;
+            m_tail = 0;
+        }
+
+    private:
+        static const uint8_t MASK = CAPACITY - 1;
+        Type m_data[CAPACITY];
+        uint8_t m_head = 0;
+        uint8_t m_tail = 0;
+};
\ No newline at end of file
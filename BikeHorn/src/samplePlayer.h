@@ -0,0 +1,225 @@
+/** samplePlayer.h
+ * Plays short recorded sounds compressed with IMA ADPCM through the piezo.
+ * 
+ * Timer 1 runs as an 8 bit PWM carrier at 62.5kHz (well above anything the
+ * piezo or anyone's ears will follow) and the duty is changed to the next
+ * sample every few cycles from the timer 1 compare B interrupt. Use
+ * Tools/sampleEncoder.py to convert a wav file to a Sample.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "power.h"
+#include "boost.h"
+
+#define SAMPLE_CARRIER (F_CPU / 256) // Timer 1 PWM frequency in Hz.
+
+// Carrier cycles until the next sample. Counted down from assembly, so needs a C name.
+extern "C" volatile uint8_t sampleCountdown;
+volatile uint8_t sampleCountdown;
+
+/**
+ * @brief A sample stored in PROGMEM.
+ * 
+ */
+struct Sample {
+    const uint8_t *data; // 4 bit ADPCM codes in PROGMEM, 2 per byte, low nibble first.
+    uint16_t length; // Number of samples.
+    uint8_t divider; // Carrier cycles per sample. The sample rate is SAMPLE_CARRIER / divider.
+    uint8_t index; // Starting step index, so that loud starts aren't smeared.
+};
+
+// IMA ADPCM step sizes.
+const uint16_t adpcmSteps[89] PROGMEM = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+// IMA ADPCM step index changes for each code magnitude.
+const int8_t adpcmIndexChanges[8] PROGMEM = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+/**
+ * @brief Plays samples in the background from the timer 1 compare B
+ * interrupt.
+ * 
+ * The interrupt happens every carrier cycle (256 clock cycles). A naked
+ * handler counts down the carrier cycles in around 30 clock cycles, saving
+ * only one register, and only jumps to the full handler to decode a sample
+ * every divider cycles. Decoding takes around 120 clock cycles plus around
+ * 80 more to save and restore the registers it uses. At the default divider
+ * of 6, this adds up to roughly a quarter of the CPU (a tenth counting down
+ * and the rest decoding). Nothing else can use timer 1 while a sample is
+ * playing.
+ * 
+ * The interrupt never calls anything out of line (so doesn't have to save
+ * every call clobbered register). When the sample finishes, it only turns
+ * itself off. isPlaying() then returns false and whoever started the sample
+ * calls stop().
+ * 
+ */
+class SamplePlayer {
+    public:
+        /**
+         * @brief Starts playing a sample. The boost stage is started if it is
+         * not already running.
+         * 
+         * @param sample the sample in PROGMEM.
+         */
+        static void play(const Sample *sample) {
+            stop();
+            Sample header;
+            memcpy_P(&header, sample, sizeof(Sample));
+            if (header.length == 0 || header.divider == 0) {
+                return;
+            }
+            s_data = header.data;
+            s_remaining = header.length;
+            s_divider = header.divider;
+            sampleCountdown = header.divider;
+            s_index = header.index;
+            s_predictor = 0;
+            s_highNibble = false;
+
+            // Fast PWM mode 5 (8 bit) on PB1 (pin 9) with no prescaler.
+            PowerManager::acquire(POWER_TIMER1);
+            BoostManager::wake();
+            OCR2A = SAMPLE_BOOST_DUTY;
+            OCR1A = 0;
+            OCR1B = 0;
+            TCNT1 = 0;
+            TCCR1A = (1 << COM1A1) | (1 << WGM10);
+            TCCR1B = (1 << WGM12) | (1 << CS10);
+            TIFR1 = (1 << OCF1B); // Clear any old compare match
+            TIMSK1 = (1 << OCIE1B);
+        }
+
+        /**
+         * @brief Stops playing and sets the boost stage back to idle. Call
+         * once isPlaying() returns false. Not safe to call from interrupts.
+         * 
+         */
+        static void stop() {
+            if (PowerManager::isOn(POWER_TIMER1) && TCCR1B) {
+                TIMSK1 = 0;
+                TCCR1A = 0;
+                TCCR1B = 0;
+                PowerManager::release(POWER_TIMER1);
+            }
+            PORTB &= ~(1 << PB1);
+            BoostManager::idle();
+        }
+
+        /**
+         * @brief Returns true if a sample is playing.
+         * 
+         */
+        static inline bool isPlaying() {
+            return PowerManager::isOn(POWER_TIMER1) && (TIMSK1 & (1 << OCIE1B));
+        }
+
+        /**
+         * @brief Outputs the next sample, or turns the interrupt off at the
+         * end. Called from the timer 1 compare B interrupt every divider
+         * carrier cycles, so is always inlined to keep the register saving to
+         * a minimum.
+         * 
+         */
+        __attribute__((always_inline)) static inline void update() {
+            sampleCountdown = s_divider;
+            if (s_remaining == 0) {
+                TIMSK1 = 0; // Finished. stop() is called from outside the interrupt.
+                OCR1A = 0;
+                return;
+            }
+            s_remaining--;
+
+            // Next code
+            uint8_t code;
+            if (s_highNibble) {
+                code = s_byte >> 4;
+            } else {
+                s_byte = pgm_read_byte(s_data++);
+                code = s_byte & 0x0f;
+            }
+            s_highNibble = !s_highNibble;
+
+            // Decode it (IMA ADPCM)
+            uint16_t step = pgm_read_word(&adpcmSteps[s_index]);
+            uint16_t difference = step >> 3;
+            if (code & 4) difference += step;
+            if (code & 2) difference += step >> 1;
+            if (code & 1) difference += step >> 2;
+            int32_t predictor = s_predictor;
+            if (code & 8) {
+                predictor -= difference;
+                if (predictor < -32768) predictor = -32768;
+            } else {
+                predictor += difference;
+                if (predictor > 32767) predictor = 32767;
+            }
+            s_predictor = predictor;
+            int8_t index = s_index + (int8_t)pgm_read_byte(&adpcmIndexChanges[code & 7]);
+            s_index = index < 0 ? 0 : (index > 88 ? 88 : index);
+
+            // Output it. Double buffered by the hardware until the next cycle.
+            uint8_t level = (uint8_t)(s_predictor >> 8) + 128;
+            OCR1A = ((uint16_t)level * SAMPLE_MAX_DUTY) >> 8;
+        }
+
+    private:
+        static const uint8_t *s_data;
+        static uint16_t s_remaining;
+        static int16_t s_predictor;
+        static uint8_t s_index;
+        static uint8_t s_byte;
+        static bool s_highNibble;
+        static uint8_t s_divider;
+};
+
+const uint8_t *SamplePlayer::s_data;
+uint16_t SamplePlayer::s_remaining;
+int16_t SamplePlayer::s_predictor;
+uint8_t SamplePlayer::s_index;
+uint8_t SamplePlayer::s_byte;
+bool SamplePlayer::s_highNibble;
+uint8_t SamplePlayer::s_divider;
+
+// The __vector prefix stops gcc warning about a misspelled interrupt handler.
+extern "C" void __vector_sampleDecode() __attribute__((signal, used, externally_visible));
+
+/**
+ * Interrupt for sample playback. Happens once every timer 1 cycle while a sample is playing. Counts down with only r24
+ * and SREG saved, then jumps to the real handler when it is time for the next sample.
+ */
+ISR(TIMER1_COMPB_vect, ISR_NAKED) {
+    asm volatile(
+        "push r24\n\t"
+        "in r24, __SREG__\n\t"
+        "push r24\n\t"
+        "lds r24, sampleCountdown\n\t"
+        "dec r24\n\t"
+        "sts sampleCountdown, r24\n\t"
+        "breq 1f\n\t"
+        "pop r24\n\t"
+        "out __SREG__, r24\n\t"
+        "pop r24\n\t"
+        "reti\n\t"
+        "1:\n\t"
+        "pop r24\n\t"
+        "out __SREG__, r24\n\t"
+        "pop r24\n\t"
+        "jmp __vector_sampleDecode\n\t"
+    );
+}
+
+/**
+ * Decodes and outputs the next sample.
+ */
+void __vector_sampleDecode() {
+    SamplePlayer::update();
+}
\ No newline at end of file
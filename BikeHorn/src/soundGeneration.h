@@ -4,9 +4,31 @@
  * 
  * Written by Jotham Gates
  * 
- * Last modified 07/11/2022
+ * Last modified 18/10/2026
  */
 #pragma once
+#include "trace.h"
+#include "power.h"
+#include "boost.h"
+#include "effects.h"
+
+/**
+ * @brief How hard to drive the piezo and boost converter, as a percentage of
+ * the duty cycles the tuning tool found to be loudest.
+ * 
+ */
+struct OutputProfile {
+    uint8_t piezo; // Timer 1 (piezo) duty percentage.
+    uint8_t boost; // Timer 2 (boost converter) duty percentage.
+};
+
+// Profiles that can be selected from the menu, trading loudness for battery life.
+const OutputProfile outputProfiles[] PROGMEM = {
+    {100, 100}, // Max
+    {90, 80}, // Normal
+    {75, 60} // Eco
+};
+#define OUTPUT_PROFILES (sizeof(outputProfiles) / sizeof(OutputProfile))
 
 /**
  * @brief Handles the task of making the most noise possible.
@@ -14,9 +36,55 @@
  */
 class BikeHornSound : public TimerOneSound {
     public:
+        /**
+         * @brief Loads the optimisation settings and output profile from
+         * EEPROM. Called by TunePlayer::begin(). Doesn't print anything, so
+         * that the horn is ready as soon as possible (see printSettings()).
+         * 
+         */
         void begin() {
-            // Load and print configs
-            if(m_timer1Piecewise.begin(EEPROM_TIMER1_PIECEWISE) && m_timer2Piecewise.begin(EEPROM_TIMER2_PIECEWISE)) {
+            uint8_t profile = 0;
+            RecordStore::read(RECORD_OUTPUT_PROFILE, &profile, sizeof(profile));
+            m_loadProfile(profile);
+        }
+
+        /**
+         * @brief Changes to another output profile and saves it to EEPROM.
+         * The profile is applied to the piecewise functions now, so playing
+         * each note takes just as long as with the full output. Don't call
+         * while a note is playing.
+         * 
+         * @param profile the index in outputProfiles.
+         */
+        void setProfile(uint8_t profile) {
+            m_loadProfile(profile);
+            RecordStore::write(RECORD_OUTPUT_PROFILE, &m_profile, sizeof(m_profile));
+        }
+
+        /**
+         * @brief Returns the index of the current output profile.
+         * 
+         */
+        inline uint8_t getProfile() const {
+            return m_profile;
+        }
+
+        /**
+         * @brief Prints the optimisation settings, or an error if they could
+         * not be loaded.
+         * 
+         */
+        void printSettings() {
+            if(m_tuned) {
+                OutputProfile profile;
+                memcpy_P(&profile, &outputProfiles[m_profile], sizeof(OutputProfile));
+                Serial.print(F("Output profile "));
+                Serial.print(m_profile);
+                Serial.print(F(" (piezo "));
+                Serial.print(profile.piezo);
+                Serial.print(F("%, boost "));
+                Serial.print(profile.boost);
+                Serial.println(F("%)"));
                 Serial.println(F("Timer 1 Optimisation settings:"));
                 m_timer1Piecewise.print();
                 Serial.println();
@@ -24,21 +92,26 @@ class BikeHornSound : public TimerOneSound {
                 m_timer2Piecewise.print();
             } else {
                 // There was an issue initialising the piecewise functions
-                Serial.println(F("ERROR: At least 1 piecewise function for optimising volume was a bit suspect and could not be loaded from EEPROM.\r\nAre you sure you have uploaded the optimised functions to EEPROM and the addresses are correct?\r\nSee https://github.com/jgOhYeah/BikeHorn/tree/main/Tuning for more info."));
+                Serial.println(F("ERROR: At least 1 piecewise function for optimising volume was a bit suspect and could not be loaded from EEPROM.\r\nAre you sure you have uploaded the optimised functions to EEPROM with the latest version of the tuning tool?\r\nSee https://github.com/jgOhYeah/BikeHorn/tree/main/Tuning for more info."));
             }
         }
 
         /** Stops the sound and sets the boost pwm back to idle */
         void stopSound() {
-            TIMSK1 = 0; // Disable the interrupt for changing the piezo frequency (warble mode).
+            EffectEngine::stop();
+            if (isPlaying()) {
+                TIMSK1 = 0; // Disable the interrupt for changing the piezo frequency (warble mode).
 
-            // Shutdown timer 1
-            TCCR1A = 0;
-            TCCR1B = 0;
+                // Shutdown timer 1
+                TCCR1A = 0;
+                TCCR1B = 0;
+                PowerManager::release(POWER_TIMER1);
+            }
             PORTD &= ~(1 << PB1); // Set pin low just in case it is left high (not sure if needed)
 
-            // Set timer 2 back to idle
-            OCR2A = IDLE_DUTY; // Enough duty to keep the voltage up ready for next note
+            // Set timer 2 back to idle and start counting down to turning it off
+            BoostManager::idle();
+            TRACE(TRACE_NOTE_STOP, 0);
         }
 
         /**
@@ -46,10 +119,25 @@ class BikeHornSound : public TimerOneSound {
          * This should be at least 31Hz
          */
         void playFreq(uint16_t frequency) {
+            TRACE(TRACE_NOTE, frequency);
+            uint16_t top = F_CPU / 8 / frequency;
+            EffectEngine::stop();
+            playTop(top);
+            m_startEffect(top);
+        }
+
+        /**
+         * Starts timer 1 with the given top value (period in timer counts with a prescaler of 8).
+         */
+        void playTop(uint16_t top) {
+            BoostManager::wake();
+            if (!isPlaying()) {
+                PowerManager::acquire(POWER_TIMER1);
+            }
             // Setup non inverting mode (duty cycle is sensible), fast pwm mode 14 on PB1 (Pin 9)
             TCCR1A = (1 << COM1A1) | (1 << WGM11);
             TCCR1B = (1 << WGM12) | (1 << WGM13) | (1 << CS11); // With prescalar 8 (with a clock frequency of 16MHz, can get all notes required)
-            ICR1 = F_CPU / 8 / frequency; // Calculate the corresponding counter
+            ICR1 = top;
             OCR1A = m_compareValue(ICR1); // Duty cycle
         }
 
@@ -57,16 +145,56 @@ class BikeHornSound : public TimerOneSound {
          * Sets the variables to do software double buffering that will update the values at the correct part of the cycle to stop glitches.
          */
         void changeFreq(uint16_t frequency) {
+            uint16_t top = F_CPU / 8 / frequency;
+            EffectEngine::stop();
+            changeTop(top);
+            m_startEffect(top);
+        }
+
+        /**
+         * Same as changeFreq, but takes the top value for timer 1 directly for finer control at low frequencies.
+         */
+        void changeTop(uint16_t top) {
             TIMSK1 = 0; // Disable this interrupt while updating the values
-            nextTop = F_CPU / 8 / frequency;
+            nextTop = top;
             nextComp = m_compareValue(nextTop);
             TIMSK1 = (1 << TOIE1); // Enable interrupts when overflowing
         }
 
+        /**
+         * Returns true if timer 1 is running (a note is playing).
+         */
+        inline bool isPlaying() const {
+            return PowerManager::isOn(POWER_TIMER1) && TCCR1B;
+        }
+
+        /**
+         * Sets the effect to apply to notes started with playFreq or changeFreq from now on.
+         * @param effect the effect in PROGMEM, or nullptr for no effect.
+         */
+        void setEffect(const Effect *effect) {
+            if (effect) {
+                memcpy_P(&m_effect, effect, sizeof(Effect));
+            } else {
+                m_effect.type = EFFECT_NONE;
+            }
+        }
+
         static volatile uint16_t nextTop;
         static volatile uint16_t nextComp;
 
     private:
+        /** Loads the piecewise functions scaled for an output profile, falling back to the first if it doesn't exist */
+        void m_loadProfile(uint8_t profile) {
+            if (profile >= OUTPUT_PROFILES) {
+                profile = 0;
+            }
+            OutputProfile percent;
+            memcpy_P(&percent, &outputProfiles[profile], sizeof(OutputProfile));
+            m_profile = profile;
+            m_tuned = m_timer1Piecewise.begin(RECORD_TIMER1_PIECEWISE, percent.piezo) && m_timer2Piecewise.begin(RECORD_TIMER2_PIECEWISE, percent.boost);
+        }
+
         /** Returns the value at which the pin should go low each time. Also sets the pwm duty of boost as it is called around the right time */
         uint16_t m_compareValue(uint16_t counter) {
             // Set Timer 2 now (a bit not proper, but should work)
@@ -74,8 +202,58 @@ class BikeHornSound : public TimerOneSound {
             return m_timer1Piecewise.apply(counter);
         }
 
+        /** Fills in the timer settings for a given timer 1 top without changing anything that is playing */
+        void m_fillStep(EffectStep &step, uint16_t top) {
+            step.top = top;
+            step.compare = m_timer1Piecewise.apply(top);
+            step.boost = m_timer2Piecewise.apply(top);
+        }
+
+        /** Works out the table for the current effect and starts stepping through it */
+        void m_startEffect(uint16_t top) {
+            EffectStep *table = EffectEngine::table;
+            uint8_t length;
+            switch (m_effect.type) {
+                case EFFECT_VIBRATO:
+                    // 1 cent is close enough to 1/1731 of the period for vibrato depths.
+                    for (uint8_t i = 0; i < EFFECT_STEPS; i++) {
+                        int32_t offset = (int32_t)top * m_effect.depth * EffectEngine::sine(i) / (127L * 1731);
+                        m_fillStep(table[i], top - offset);
+                    }
+                    length = EFFECT_STEPS;
+                    break;
+
+                case EFFECT_TREMOLO: {
+                    // Only the piezo duty changes, so the piecewise functions are only needed once.
+                    EffectStep full;
+                    m_fillStep(full, top);
+                    uint8_t depth = min(m_effect.depth, 100); // Any deeper would make the compare value wrap around
+                    for (uint8_t i = 0; i < EFFECT_STEPS; i++) {
+                        table[i] = full;
+                        table[i].compare -= (uint32_t)full.compare * depth * (127 - EffectEngine::sine(i)) / (100L * 254);
+                    }
+                    length = EFFECT_STEPS;
+                    break;
+                }
+
+                case EFFECT_ARPEGGIO:
+                    length = min(m_effect.depth, EFFECT_ARPEGGIO_NOTES);
+                    for (uint8_t i = 0; i < length; i++) {
+                        m_fillStep(table[i], EffectEngine::transpose(top, m_effect.notes[i]));
+                    }
+                    break;
+
+                default:
+                    return;
+            }
+            EffectEngine::start(length, m_effect.ticks);
+        }
+
         PiecewiseLinear m_timer1Piecewise;
         PiecewiseLinear m_timer2Piecewise;
+        bool m_tuned = false;
+        uint8_t m_profile = 0;
+        Effect m_effect = NO_EFFECT;
 };
 
 #ifdef ENABLE_WARBLE
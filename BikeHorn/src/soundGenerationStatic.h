@@ -6,7 +6,7 @@
  * 
  * Written by Jotham Gates
  * 
- * Last modified 06/11/2022
+ * Last modified 18/10/2026
  */
 #pragma once
 #include "soundGeneration.h"
@@ -15,6 +15,27 @@
 volatile uint16_t BikeHornSound::nextTop;
 volatile uint16_t BikeHornSound::nextComp;
 
+EffectStep EffectEngine::table[EFFECT_STEPS];
+uint8_t EffectEngine::s_length;
+uint8_t EffectEngine::s_ticks;
+uint8_t EffectEngine::s_countdown;
+uint8_t EffectEngine::s_index;
+
+void EffectEngine::update() {
+    if (--s_countdown == 0) {
+        s_countdown = s_ticks;
+        s_index++;
+        if (s_index == s_length) {
+            s_index = 0;
+        }
+        const EffectStep &step = table[s_index];
+        BikeHornSound::nextTop = step.top;
+        BikeHornSound::nextComp = step.compare;
+        OCR2A = step.boost; // Double buffered by the hardware in fast PWM mode
+        TIMSK1 = (1 << TOIE1); // Apply the rest at the start of the next timer 1 cycle
+    }
+}
+
 /**
  * Interrupt for timer overflow to change the frequency of the warble safely at the correct time in the cycle without
  * using a double buffered register. The manual suggests OCR1A should be set as top as it is double buffered, however
@@ -32,4 +53,12 @@ ISR(TIMER1_OVF_vect) {
     ICR1 = BikeHornSound::nextTop;
     OCR1A = BikeHornSound::nextComp;
     TIMSK1 = 0; // Disable timer 1 interrupts
+}
+
+/**
+ * Interrupt for stepping through effects. Timer 0 is also used for millis(), so this happens once every 1.024ms at
+ * the same point in each timer 0 cycle, no matter what the main loop is doing.
+ */
+ISR(TIMER0_COMPB_vect) {
+    EffectEngine::update();
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+/** trace.cpp
+ * See trace.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include <Arduino.h>
+#include "trace.h"
+
+#ifdef ENABLE_TRACE
+RingBuffer<TraceEvent, TRACE_LENGTH> Trace::s_events;
+
+void Trace::dump() {
+    // Take the count at the start so that events added while sending don't
+    // make this go on forever.
+    uint8_t oldSREG = SREG;
+    cli();
+    uint8_t count = s_events.count();
+    SREG = oldSREG;
+
+    Serial.write("TRCE");
+    Serial.write(TRACE_VERSION);
+    Serial.write(64000000UL / F_CPU); // Timer 0 prescaler is 64.
+    Serial.write(count);
+    Serial.write(sizeof(TraceEvent));
+    for (uint8_t i = 0; i < count; i++) {
+        oldSREG = SREG;
+        cli();
+        TraceEvent event = s_events.pop();
+        SREG = oldSREG;
+        Serial.write((const uint8_t*)&event, sizeof(TraceEvent));
+    }
+    Serial.flush();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+/** trace.h
+ * Records timestamped events to a small ring buffer in RAM so that the timing
+ * of the horn can be seen without slowing it down with serial prints.
+ * 
+ * Enable with ENABLE_TRACE in defines.h. When disabled, TRACE() does nothing
+ * (apart from telling the watchdog monitor if ENABLE_WATCHDOG_FORENSICS is
+ * defined).
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#pragma once
+#include "../defines.h"
+
+#define TRACE_VERSION 1
+
+/**
+ * @brief Event IDs. These need to match EVENTS in Tools/traceDecoder.py.
+ * 
+ */
+enum TraceId : uint8_t {
+    TRACE_SLEEP,            // About to power down. arg: 0.
+    TRACE_WAKE,             // Woken up. arg: wakePin.
+    TRACE_BUTTON,           // Button interrupt. arg: wakePin.
+    TRACE_BOOST_START,      // arg: duty (OCR2A).
+    TRACE_BOOST_STOP,       // arg: 0.
+    TRACE_TUNE_PLAY,        // arg: tune index, or 0xffff for a UI beep.
+    TRACE_NOTE,             // Note started. arg: frequency in Hz.
+    TRACE_NOTE_STOP,        // arg: 0.
+    TRACE_EXT_START,        // Extension onStart() called. arg: extension index.
+    TRACE_EXT_WAKE,         // Extension onWake() called. arg: extension index.
+    TRACE_EXT_SLEEP,        // Extension onSleep() called. arg: extension index.
+    TRACE_EXT_TUNE_START,   // Extension onTuneStart() called. arg: extension index.
+    TRACE_EXT_TUNE_STOP,    // Extension onTuneStop() called. arg: extension index.
+    TRACE_EXT_DONE,         // All extensions returned from a hook. arg: the TraceId of the hook.
+    TRACE_EEPROM_WRITE,     // EEPROM write started. arg: address.
+    TRACE_EEPROM_DONE,      // Background EEPROM write finished. arg: 0.
+    TRACE_STATE,            // Burgler alarm state entered. arg: StateId.
+    TRACE_EXT_MENU          // Extension menu item run. arg: extension index.
+};
+
+#ifdef ENABLE_TRACE
+#include "ringBuffer.h"
+
+// Defined in wiring.c and incremented by the timer 0 overflow interrupt that
+// millis() uses.
+extern "C" volatile unsigned long timer0_overflow_count;
+
+/**
+ * @brief A single event.
+ * 
+ */
+struct TraceEvent {
+    uint32_t time; // Timer 0 ticks (4us each at 16MHz).
+    uint8_t id;
+    uint16_t arg;
+} __attribute__((packed));
+
+/**
+ * @brief Class for recording trace events.
+ * 
+ */
+class Trace {
+    public:
+        /**
+         * @brief Adds an event to the buffer, overwriting the oldest if full.
+         * Safe to call from interrupts.
+         * 
+         * Timer 0 stops while powered down, so time asleep does not appear in
+         * the timestamps.
+         * 
+         * @param id the event (TraceId).
+         * @param arg extra information about the event.
+         */
+        static inline void add(uint8_t id, uint16_t arg) {
+            uint8_t oldSREG = SREG;
+            cli();
+            // Same idea as micros(), but without the multiplication.
+            uint8_t ticks = TCNT0;
+            uint32_t overflows = timer0_overflow_count;
+            if ((TIFR0 & bit(TOV0)) && ticks != 255) {
+                // Overflowed, but the interrupt hasn't run yet.
+                overflows++;
+            }
+            TraceEvent event = {overflows << 8 | ticks, id, arg};
+            s_events.push(event);
+            SREG = oldSREG;
+        }
+
+        /**
+         * @brief Sends and removes all events over serial in binary.
+         * 
+         * The format is "TRCE", then 1 byte each for the version, us per
+         * timer tick, number of events and size of each event, followed by
+         * the events oldest first.
+         * 
+         */
+        static void dump();
+
+    private:
+        static RingBuffer<TraceEvent, TRACE_LENGTH> s_events;
+};
+#endif
+
+// The watchdog monitor keeps the last trace point in case the horn gets stuck.
+#if defined(ENABLE_TRACE) && defined(ENABLE_WATCHDOG_FORENSICS)
+#define TRACE(id, arg) do { Trace::add(id, arg); WatchdogMonitor::mark(id, arg); } while (0)
+#elif defined(ENABLE_TRACE)
+#define TRACE(id, arg) Trace::add(id, arg)
+#elif defined(ENABLE_WATCHDOG_FORENSICS)
+#define TRACE(id, arg) WatchdogMonitor::mark(id, arg)
+#else
+#define TRACE(id, arg)
+#endif
\ No newline at end of file
@@ -0,0 +1,191 @@
+/** watchdog.cpp
+ * See watchdog.h for more info
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+
+#include "trace.h"
+#include "watchdog.h"
+
+// Written before .bss is cleared, so needs to be in .noinit.
+uint8_t WatchdogMonitor::s_resetCause __attribute__((section(".noinit")));
+
+void WatchdogMonitor::m_saveResetCause() {
+    uint8_t cause = MCUSR;
+    if (!cause) {
+        // Optiboot clears MCUSR and passes what it was in r2.
+        asm volatile("mov %0, r2" : "=r" (cause));
+    }
+    s_resetCause = cause;
+    MCUSR = 0;
+    wdt_disable(); // Still running after a watchdog reset
+}
+
+#ifdef ENABLE_WATCHDOG_FORENSICS
+#include "boost.h"
+
+WatchdogCapture WatchdogMonitor::s_capture __attribute__((section(".noinit")));
+volatile bool WatchdogMonitor::s_enabled = false;
+volatile bool WatchdogMonitor::s_fed = false;
+bool WatchdogMonitor::s_captured = false;
+uint16_t WatchdogMonitor::s_ticks = 0;
+uint16_t WatchdogMonitor::s_traceArg = 0;
+uint8_t WatchdogMonitor::s_traceId = 0;
+uint8_t WatchdogMonitor::s_state = WATCHDOG_NONE;
+uint8_t WatchdogMonitor::s_extension = WATCHDOG_NONE;
+
+// Stack pointer at the start of the timer 0 compare A interrupt (after r24 is saved). Written from assembly, so
+// needs a C name.
+extern "C" volatile uint16_t watchdogStack;
+volatile uint16_t watchdogStack;
+
+void WatchdogMonitor::enable() {
+    wdt_enable(WDTO_4S);
+    uint8_t oldSREG = SREG;
+    cli();
+    s_fed = true;
+    s_enabled = true;
+    TIMSK0 |= (1 << OCIE0A);
+    SREG = oldSREG;
+}
+
+void WatchdogMonitor::disable() {
+    wdt_disable();
+    s_enabled = false; // The interrupt leaves everything alone from now on
+    if (s_captured) {
+        s_captured = false;
+        s_capture.magic = 0;
+    }
+    // BoostManager::tick() turns the interrupt off once the boost doesn't need it either.
+}
+
+void WatchdogMonitor::mark(uint8_t id, uint16_t arg) {
+    uint8_t oldSREG = SREG;
+    cli();
+    s_traceId = id;
+    s_traceArg = arg;
+    switch (id) {
+        case TRACE_STATE:
+            s_state = arg;
+            break;
+        case TRACE_EXT_START:
+        case TRACE_EXT_WAKE:
+        case TRACE_EXT_SLEEP:
+        case TRACE_EXT_TUNE_START:
+        case TRACE_EXT_TUNE_STOP:
+        case TRACE_EXT_MENU:
+            s_extension = arg;
+            break;
+        case TRACE_EXT_DONE:
+            s_extension = WATCHDOG_NONE;
+            if (arg == TRACE_EXT_MENU) {
+                s_state = WATCHDOG_NONE; // The burgler alarm only runs from the menu
+            }
+            break;
+    }
+    SREG = oldSREG;
+}
+
+void WatchdogMonitor::tick() {
+    if (!s_enabled) {
+        return;
+    }
+
+    if (s_fed) {
+        // Still going. Forget anything captured as the reset won't happen.
+        s_fed = false;
+        s_ticks = 0;
+        if (s_captured) {
+            s_captured = false;
+            s_capture.magic = 0;
+        }
+    } else if (++s_ticks == WATCHDOG_CAPTURE_TICKS) {
+        // Nearly out of time. The return address (high byte first) was pushed before r24.
+        const uint8_t *stack = (const uint8_t*)watchdogStack;
+        s_capture.address = (uint16_t)(stack[2] << 8 | stack[3]) << 1;
+        s_capture.stack = watchdogStack + 3;
+        s_capture.traceId = s_traceId;
+        s_capture.traceArg = s_traceArg;
+        s_capture.state = s_state;
+        s_capture.extension = s_extension;
+        s_capture.magic = WATCHDOG_MAGIC;
+        s_captured = true;
+    }
+}
+
+void WatchdogMonitor::report() {
+    uint8_t cause = s_resetCause;
+    Serial.print(F("Reset by"));
+    if (cause & (1 << PORF)) {
+        Serial.print(F(" power on"));
+    }
+    if (cause & (1 << EXTRF)) {
+        Serial.print(F(" reset pin"));
+    }
+    if (cause & (1 << BORF)) {
+        Serial.print(F(" brown out"));
+    }
+    if (cause & (1 << WDRF)) {
+        Serial.print(F(" watchdog"));
+    }
+    if (!cause) {
+        Serial.print(F(" unknown"));
+    }
+    Serial.println();
+
+    if ((cause & (1 << WDRF)) && s_capture.magic == WATCHDOG_MAGIC) {
+        Serial.print(F("Stuck at 0x"));
+        Serial.print(s_capture.address, HEX);
+        Serial.print(F(" with the stack at 0x"));
+        Serial.print(s_capture.stack, HEX);
+        Serial.print(F(" after trace point "));
+        Serial.print(s_capture.traceId);
+        Serial.print(F(" ("));
+        Serial.print(s_capture.traceArg);
+        Serial.print(')');
+        if (s_capture.state != WATCHDOG_NONE) {
+            Serial.print(F(" in alarm state "));
+            Serial.print(s_capture.state);
+        }
+        if (s_capture.extension != WATCHDOG_NONE) {
+            Serial.print(F(" in extension "));
+            Serial.print(s_capture.extension);
+        }
+        Serial.println();
+    }
+    s_capture.magic = 0;
+}
+
+// The __vector prefix stops gcc warning about a misspelled interrupt handler.
+extern "C" void __vector_watchdogTick() __attribute__((signal, used, externally_visible));
+
+/**
+ * @brief Saves the stack pointer so that the return address can be found,
+ * then jumps to the real interrupt handler. Doesn't change SREG.
+ * 
+ */
+ISR(TIMER0_COMPA_vect, ISR_NAKED) {
+    asm volatile(
+        "push r24\n\t"
+        "in r24, __SP_L__\n\t"
+        "sts watchdogStack, r24\n\t"
+        "in r24, __SP_H__\n\t"
+        "sts watchdogStack+1, r24\n\t"
+        "pop r24\n\t"
+        "jmp __vector_watchdogTick\n\t"
+    );
+}
+
+/**
+ * @brief Ticks the watchdog monitor and steps the boost soft start and idle
+ * timeout. Timer 0 is also used for millis(), so this happens once every
+ * 1.024ms.
+ * 
+ */
+void __vector_watchdogTick() {
+    WatchdogMonitor::tick();
+    BoostManager::tick();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+/** watchdog.h
+ * Records where the horn was stuck before a watchdog reset and reports it
+ * (along with the reset cause) on the next boot.
+ * 
+ * The Low-Power library owns the watchdog interrupt, so the watchdog can't
+ * be put in interrupt then reset mode to save anything. Instead, the timer 0
+ * compare A interrupt counts how long it has been since the watchdog was last
+ * reset and saves what was happening to RAM that isn't cleared on startup a
+ * little before the hardware watchdog is due to reset the microcontroller.
+ * 
+ * Enable with ENABLE_WATCHDOG_FORENSICS in defines.h. The reset cause is saved
+ * either way (see resetCause()).
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include <Arduino.h>
+#include <avr/wdt.h>
+
+#define WATCHDOG_MAGIC 0xd06e // Marks a saved capture as valid.
+#define WATCHDOG_NONE 0xff // No burgler alarm state or extension.
+
+/**
+ * @brief What was happening when the watchdog was about to reset. Kept in the
+ * .noinit section so that it survives the reset.
+ * 
+ */
+struct WatchdogCapture {
+    uint16_t magic; // WATCHDOG_MAGIC if valid.
+    uint16_t address; // Byte address of the instruction that was interrupted.
+    uint16_t stack; // Stack pointer of the interrupted code.
+    uint16_t traceArg; // Argument of the last trace point.
+    uint8_t traceId; // Last trace point (TraceId).
+    uint8_t state; // Current burgler alarm state (StateId) or WATCHDOG_NONE.
+    uint8_t extension; // Index of the extension running a hook or menu item, or WATCHDOG_NONE.
+};
+
+/**
+ * @brief Wraps the watchdog timer and keeps track of what the horn is doing
+ * in case it gets stuck.
+ * 
+ * Trace points are recorded through mark() even when ENABLE_TRACE is not
+ * defined, so the last one reached before getting stuck is known. Code that
+ * gets stuck with interrupts disabled can't be captured, but the reset cause
+ * is still reported.
+ * 
+ */
+class WatchdogMonitor {
+    public:
+        /**
+         * @brief Starts the watchdog timer and the monitor.
+         * 
+         */
+        static void enable();
+
+        /**
+         * @brief Stops the watchdog timer and the monitor. Anything captured
+         * is discarded as the reset won't happen.
+         * 
+         */
+        static void disable();
+
+        /**
+         * @brief Resets the watchdog timer. Anything captured is discarded
+         * the next time the monitor ticks.
+         * 
+         */
+        static inline void reset() {
+            wdt_reset();
+            s_fed = true;
+        }
+
+        /**
+         * @brief Returns true if the monitor needs the timer 0 compare A
+         * interrupt.
+         * 
+         */
+        static inline bool isEnabled() {
+            return s_enabled;
+        }
+
+        /**
+         * @brief Records a trace point. Called by TRACE(). Safe to call from
+         * interrupts.
+         * 
+         * @param id the event (TraceId).
+         * @param arg extra information about the event.
+         */
+        static void mark(uint8_t id, uint16_t arg);
+
+        /**
+         * @brief Counts the time since the watchdog was last reset and
+         * captures what was happening when it gets close to resetting. Called
+         * from the timer 0 compare A interrupt.
+         * 
+         */
+        static void tick();
+
+        /**
+         * @brief Prints the reset cause and anything captured before the last
+         * watchdog reset over serial. The capture is only reported once.
+         * 
+         */
+        static void report();
+
+        /**
+         * @brief Returns the reset flags (MCUSR) from when the horn started.
+         * Available without ENABLE_WATCHDOG_FORENSICS.
+         * 
+         */
+        static inline uint8_t resetCause() {
+            return s_resetCause;
+        }
+
+    private:
+        /**
+         * @brief Saves MCUSR before anything else runs. Placed in .init3 so
+         * that it runs before .bss is cleared and the constructors are called.
+         * 
+         */
+        static void m_saveResetCause() __attribute__((naked, used, section(".init3")));
+
+        static WatchdogCapture s_capture;
+        static uint8_t s_resetCause;
+        static volatile bool s_enabled;
+        static volatile bool s_fed;
+        static bool s_captured;
+        static uint16_t s_ticks;
+        static uint16_t s_traceArg;
+        static uint8_t s_traceId;
+        static uint8_t s_state;
+        static uint8_t s_extension;
+};
\ No newline at end of file
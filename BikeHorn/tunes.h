@@ -6,9 +6,10 @@
  * https://github.com/jgOhYeah/BikeHorn
  * 
  * Written by Jotham Gates. Tunes converted from various sources.
- * Last modified 11/01/2021
+ * Last modified 18/10/2026
  */
 #pragma once
+#include "src/effects.h"
 
 // Converted from 'WeWishYouAMerryChristmas' by TunePlayer Musescore plugin V1.8.0
 const uint16_t WeWishYouAMerryChristmas[] PROGMEM = {
@@ -154,4 +155,21 @@ const uint16_t babyShark[] PROGMEM = {
 const uint16_t *const tunes[] PROGMEM = {WeWishYouAMerryChristmas, auld_lang_syne_PNO_orig, rossini_william_tell, BlueBikeHorn, TakeOnMeIntroLoop, ImperialMarchPICAXE, FinalCountdownLow, FinalCountdownHigh, Cantina, beep, beepHigh};
 const uint8_t tuneCount = sizeof(tunes) / sizeof(uint16_t);
 
+// Effect to play each tune with, in the same order as tunes. Use NO_EFFECT, VIBRATO(ticks, cents), TREMOLO(ticks,
+// percent) or ARPEGGIO(ticks, count, semitones...). See src/effects.h for more info.
+const Effect tuneEffects[] PROGMEM = {
+    VIBRATO(10, 20), // WeWishYouAMerryChristmas, gentle 6Hz vibrato
+    NO_EFFECT, // auld_lang_syne_PNO_orig
+    NO_EFFECT, // rossini_william_tell
+    NO_EFFECT, // BlueBikeHorn
+    NO_EFFECT, // TakeOnMeIntroLoop
+    TREMOLO(8, 50), // ImperialMarchPICAXE, 8Hz
+    NO_EFFECT, // FinalCountdownLow
+    NO_EFFECT, // FinalCountdownHigh
+    ARPEGGIO(25, 3, 0, 4, 7), // Cantina, major chord
+    NO_EFFECT, // beep
+    NO_EFFECT // beepHigh
+};
+static_assert(sizeof(tuneEffects) / sizeof(Effect) == sizeof(tunes) / sizeof(tunes[0]), "tuneEffects needs an effect for each tune");
+
 #define BURGLER_ALARM_TUNE babyShark
\ No newline at end of file
@@ -0,0 +1,303 @@
+/** alarmReplay.cpp
+ * Replays recorded or synthetic accelerometer traces through the burgler
+ * alarm's movement detection code (accelerometer.h and statistics.h) on a
+ * computer and reports how well it detected movement. Either detector can be
+ * tested by building with or without ACCEL_EWMA_CUSUM defined.
+ * 
+ * Traces are CSV files with a line per sample of "x,y,z" or "x,y,z,event",
+ * where x, y and z are raw ADC readings and event is 1 while the bike was
+ * really being moved and 0 otherwise. Lines starting with '#' are ignored.
+ * 
+ * See Readme.md for usage.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "Arduino.h" // Stub, after the standard library as it defines min and max macros.
+
+// As in defines.h
+#define ACCEL_X_PIN A4
+#define ACCEL_Y_PIN A3
+#define ACCEL_Z_PIN A2
+#define ACCEL_POWER_PIN A5
+
+#include "clock.h" // Stub, included by burglerAlarm.h on the horn.
+
+#include "alarmSettings.h"
+#include "accelerometer.h"
+
+uint8_t ADMUX;
+uint8_t ADCSRA;
+uint8_t PRR;
+
+struct Sample {
+    int16_t axis[3];
+    bool event;
+};
+
+static std::vector<Sample> trace;
+static size_t position = 0;
+
+/**
+ * @brief Returns the reading for the current sample in the trace.
+ * 
+ * @param channel the ADC channel (pin - A0).
+ * @return int16_t the reading.
+ */
+int16_t stubReadADC(uint8_t channel) {
+    const Sample &sample = trace[position];
+    if (channel == ACCEL_X_PIN - A0) {
+        return sample.axis[0];
+    } else if (channel == ACCEL_Y_PIN - A0) {
+        return sample.axis[1];
+    } else {
+        return sample.axis[2];
+    }
+}
+
+/**
+ * @brief Loads a trace from a CSV file.
+ * 
+ * @return true if successful.
+ */
+bool loadTrace(const char *filename) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        perror(filename);
+        return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        int x, y, z, event = 0;
+        if (sscanf(line, "%d,%d,%d,%d", &x, &y, &z, &event) < 3) {
+            fprintf(stderr, "Could not read line %zu: %s", trace.size() + 1, line);
+            fclose(file);
+            return false;
+        }
+        trace.push_back({{(int16_t)x, (int16_t)y, (int16_t)z}, event != 0});
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief Generates a trace of noise with the occasional bump or push.
+ * 
+ * @param samples the number of samples to generate.
+ * @param noise the standard deviation of the noise in ADC counts.
+ * @param events the number of movements to add.
+ * @param seed for the random number generator.
+ */
+void generateTrace(size_t samples, double noise, unsigned events, unsigned seed) {
+    std::mt19937 random(seed);
+    std::normal_distribution<double> gaussian(0, noise);
+    const double resting[3] = {512, 512, 614}; // About 1g on z
+    double offset[3] = {0, 0, 0};
+
+    // Start times of events, leaving room for calibration at the start.
+    std::vector<size_t> starts;
+    std::uniform_int_distribution<size_t> startDist(PREVIOUS_RECORDS * 4, samples > 100 ? samples - 40 : samples);
+    for (unsigned i = 0; i < events; i++) {
+        starts.push_back(startDist(random));
+    }
+
+    trace.resize(samples);
+    for (size_t i = 0; i < samples; i++) {
+        trace[i].event = false;
+        for (uint8_t j = 0; j < 3; j++) {
+            trace[i].axis[j] = lround(resting[j] + offset[j] + gaussian(random));
+        }
+    }
+
+    // Add the events. Even events are a bump, odd are a slow push.
+    for (unsigned i = 0; i < starts.size(); i++) {
+        size_t start = starts[i];
+        size_t length = i % 2 ? 24 : 2;
+        for (size_t k = 0; k < length && start + k < samples; k++) {
+            Sample &sample = trace[start + k];
+            sample.event = true;
+            if (i % 2) {
+                // Being wheeled away, gradually tilting with small vibrations
+                sample.axis[0] += k / 2 + lround(gaussian(random) * 2);
+                sample.axis[2] -= k / 3;
+            } else {
+                // Bumped
+                sample.axis[i % 3] += k ? -20 : 40;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Saves the trace to a CSV file.
+ */
+bool saveTrace(const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        perror(filename);
+        return false;
+    }
+    fprintf(file, "# x,y,z,event\n");
+    for (const Sample &sample : trace) {
+        fprintf(file, "%d,%d,%d,%d\n", sample.axis[0], sample.axis[1], sample.axis[2], sample.event);
+    }
+    fclose(file);
+    return true;
+}
+
+void printUsage(const char *name) {
+    fprintf(stderr,
+        "Usage: %s [options] [trace.csv]\n"
+        "  -r, --rate HZ          samples per second in the trace (default 4)\n"
+        "  -s, --synthetic HOURS  generate a trace instead of reading one\n"
+        "  -n, --noise STD        noise of the generated trace in ADC counts (default 1.5)\n"
+        "  -e, --events N         movements to add to the generated trace (default 20)\n"
+        "  -S, --seed N           seed for the generated trace (default 1)\n"
+        "  -w, --write FILE       save the trace to a CSV file\n"
+        "  -v, --verbose          print each detection\n", name);
+}
+
+int main(int argc, char *argv[]) {
+    double rate = 4;
+    double syntheticHours = 0;
+    double noise = 1.5;
+    unsigned events = 20;
+    unsigned seed = 1;
+    const char *writeFile = nullptr;
+    bool verbose = false;
+
+    static const option options[] = {
+        {"rate", required_argument, nullptr, 'r'},
+        {"synthetic", required_argument, nullptr, 's'},
+        {"noise", required_argument, nullptr, 'n'},
+        {"events", required_argument, nullptr, 'e'},
+        {"seed", required_argument, nullptr, 'S'},
+        {"write", required_argument, nullptr, 'w'},
+        {"verbose", no_argument, nullptr, 'v'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "r:s:n:e:S:w:vh", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'r': rate = atof(optarg); break;
+            case 's': syntheticHours = atof(optarg); break;
+            case 'n': noise = atof(optarg); break;
+            case 'e': events = atoi(optarg); break;
+            case 'S': seed = atoi(optarg); break;
+            case 'w': writeFile = optarg; break;
+            case 'v': verbose = true; break;
+            default: printUsage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    // Get the trace
+    if (syntheticHours > 0) {
+        generateTrace(syntheticHours * 3600 * rate, noise, events, seed);
+    } else if (optind < argc) {
+        if (!loadTrace(argv[optind])) {
+            return 1;
+        }
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (writeFile && !saveTrace(writeFile)) {
+        return 1;
+    }
+    if (trace.size() <= PREVIOUS_RECORDS) {
+        fprintf(stderr, "The trace needs more than %d samples\n", PREVIOUS_RECORDS);
+        return 1;
+    }
+
+    // Calibrate like StateInit
+    static Acceleromenter accelerometer;
+    for (position = 0; position < PREVIOUS_RECORDS; position++) {
+        accelerometer.calibrate();
+    }
+
+    // Run the detection on every remaining sample as in StateAlert.
+    unsigned detected = 0, missed = 0, falsePositives = 0;
+    size_t latencyTotal = 0, latencyMax = 0, quietSamples = 0;
+    size_t eventStart = 0;
+    bool inEvent = false, eventDetected = false, previousMoved = false;
+    double cpuTotal = 0, cpuMax = 0;
+    for (; position < trace.size(); position++) {
+        const Sample &sample = trace[position];
+
+        // Keep track of events
+        if (sample.event && !inEvent) {
+            inEvent = true;
+            eventDetected = false;
+            eventStart = position;
+        } else if (!sample.event && inEvent) {
+            inEvent = false;
+            if (!eventDetected) {
+                missed++;
+                if (verbose) {
+                    printf("Missed event at sample %zu\n", eventStart);
+                }
+            }
+        }
+        if (!sample.event) {
+            quietSamples++;
+        }
+
+        // Detection
+        auto start = std::chrono::steady_clock::now();
+        bool moved = accelerometer.isMoved();
+        double cpu = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        cpuTotal += cpu;
+        cpuMax = max(cpuMax, cpu);
+
+        if (moved) {
+            if (inEvent && !eventDetected) {
+                eventDetected = true;
+                detected++;
+                size_t latency = position - eventStart;
+                latencyTotal += latency;
+                latencyMax = max(latencyMax, latency);
+                if (verbose) {
+                    printf("Detected event at sample %zu after %zu samples (axes %d)\n", eventStart, latency, accelerometer.movedAxes());
+                }
+            } else if (!inEvent && !previousMoved) {
+                falsePositives++;
+                if (verbose) {
+                    printf("False positive at sample %zu (axes %d)\n", position, accelerometer.movedAxes());
+                }
+            }
+        }
+        previousMoved = moved;
+    }
+    if (inEvent && !eventDetected) {
+        missed++;
+    }
+
+    // Report
+    double quietHours = quietSamples / rate / 3600;
+#ifdef ACCEL_EWMA_CUSUM
+    printf("Settings: EwmaCusum, EWMA_SHIFT %d, STD_DEVIATIONS %g, NEAR_STD_DEVIATIONS %g, CUSUM_SLACK %d, CUSUM_LIMIT %d\n",
+        EWMA_SHIFT, (double)STD_DEVIATIONS, (double)NEAR_STD_DEVIATIONS, CUSUM_SLACK, CUSUM_LIMIT);
+#else
+    printf("Settings: NullHypothesis, PREVIOUS_RECORDS %d, STD_DEVIATIONS %g, NEAR_STD_DEVIATIONS %g, ACCEL_CASCADE_REFRESH %d\n",
+        PREVIOUS_RECORDS, (double)STD_DEVIATIONS, (double)NEAR_STD_DEVIATIONS, ACCEL_CASCADE_REFRESH);
+#endif
+    printf("Samples: %zu (%.2f hours at %g Hz)\n", trace.size(), trace.size() / rate / 3600, rate);
+    printf("Events: %u detected, %u missed\n", detected, missed);
+    if (detected) {
+        printf("Detection latency: %.2f samples mean, %zu samples max\n", (double)latencyTotal / detected, latencyMax);
+    }
+    printf("False positives: %u (%.2f per hour)\n", falsePositives, quietHours > 0 ? falsePositives / quietHours : 0);
+    printf("CPU time per sample on this computer: %.3f us mean, %.3f us max\n", cpuTotal / (trace.size() - PREVIOUS_RECORDS), cpuMax);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+/** statisticsTest.cpp
+ * Checks the burgler alarm's movement detectors (statistics.h) on a computer.
+ * Each test feeds a detector generated data and checks what it learnt. Exits
+ * with 0 if every test passed.
+ * 
+ * See Readme.md for usage.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#include <stdlib.h>
+#include <math.h>
+#include <random>
+#include "Arduino.h" // Stub, after the standard library as it defines min and max macros.
+#include "alarmSettings.h"
+#include "statistics.h"
+
+static unsigned failures = 0;
+
+/**
+ * @brief Prints the result of a test and counts failures.
+ * 
+ * @param name the name of the test.
+ * @param passed true if it passed.
+ */
+static void check(const char *name, bool passed) {
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+    if (!passed) {
+        failures++;
+    }
+}
+
+/**
+ * @brief Feeds EwmaCusum 8 hours (at 4Hz) of zero mean noise and checks that
+ * the mean averages out near 0 (rounding doesn't bias it) and the standard
+ * deviation ends up near the noise's.
+ * 
+ * @param noise the standard deviation of the noise in ADC counts.
+ */
+static void ewmaZeroMean(double noise) {
+    std::mt19937 random(1);
+    std::normal_distribution<double> gaussian(0, noise);
+    EwmaCusum detector;
+    for (uint8_t i = 0; i < PREVIOUS_RECORDS; i++) {
+        detector.add(lround(gaussian(random)));
+    }
+
+    const uint32_t SAMPLES = 115200;
+    double meanSum = 0;
+    unsigned unlikely = 0;
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        unlikely += detector.isUnlikely(lround(gaussian(random)));
+        meanSum += detector.mean();
+    }
+    double averageMean = meanSum / SAMPLES;
+    printf("    noise %.1f: average mean %.3f, std %.3f, %u unlikely\n", noise, averageMean, detector.std(), unlikely);
+
+    char name[64];
+    snprintf(name, sizeof(name), "EwmaCusum mean stays near 0 (noise %.1f)", noise);
+    check(name, fabs(averageMean) < 0.1);
+    snprintf(name, sizeof(name), "EwmaCusum std follows the noise (noise %.1f)", noise);
+    check(name, fabs(detector.std() - max(noise, 1.0)) < max(noise, 1.0) * 0.5);
+}
+
+int main() {
+    ewmaZeroMean(0.6);
+    ewmaZeroMean(3);
+    if (failures) {
+        printf("%u failed\n", failures);
+        return 1;
+    }
+    printf("All passed\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+/** Arduino.h
+ * Just enough of the Arduino API for the burgler alarm's detection code to
+ * compile and run on a computer. The ADC reads from the trace being replayed.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+// Registers
+extern uint8_t ADMUX;
+extern uint8_t ADCSRA;
+int16_t stubReadADC(uint8_t channel);
+#define ADC stubReadADC(ADMUX & 0x07)
+#define REFS0 6
+#define ADEN 7
+#define ADSC 6
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+extern uint8_t PRR;
+#define PRTWI 7
+#define PRTIM2 6
+#define PRTIM1 3
+#define PRSPI 2
+#define PRUSART0 1
+#define PRADC 0
+
+// Pins
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline volatile uint8_t *portModeRegister(uint8_t) {
+    static volatile uint8_t ddr = 0;
+    return &ddr;
+}
+#define digitalPinToPort(pin) (0)
+#define digitalPinToBitMask(pin) (bit((pin) & 0x07))
+inline int16_t analogRead(uint8_t pin) {
+    return stubReadADC(pin - A0);
+}
+
+// Macros
+#define bit(b) (1UL << (b))
+#define bitSet(value, b) ((value) |= bit(b))
+#define bit_is_set(sfr, b) (0) // Conversions finish instantly
+#undef abs
+#define abs(x) ((x)>0?(x):-(x))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define min(a,b) ((a)<(b)?(a):(b))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
\ No newline at end of file
@@ -0,0 +1,25 @@
+/** clock.h
+ * Stands in for BikeHorn/src/clock.h with ENABLE_CLOCK_SCALING off, which
+ * can't be included here as it pulls in defines.h and the horn's libraries.
+ * 
+ * Written by Jotham Gates
+ * Created 18/10/2026
+ * Last modified 18/10/2026
+ */
+#pragma once
+#include "Arduino.h"
+
+// As in BikeHorn/src/clock.h
+#define ADC_PRESCALER_FAST (bit(ADPS2) | bit(ADPS1) | bit(ADPS0)) // 16MHz / 128
+
+class ClockManager {
+    public:
+        static inline void slow() {}
+        static inline void fast() {}
+        static inline bool isSlow() {
+            return false;
+        }
+        static inline uint8_t adcPrescaler() {
+            return ADC_PRESCALER_FAST;
+        }
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""alarmLogDecoder.py
+Reads the burgler alarm trigger log from the horn and prints it in a readable
+format.
+
+Select "Dump the alarm trigger log" from the horn's menu while this script is
+running. The log can also be decoded from a file containing a saved dump.
+
+For more details, see Documentation/BurglerAlarm.md or go to
+https://github.com/jgOhYeah/BikeHorn
+
+Written by Jotham Gates
+Created 18/10/2026
+Last modified 18/10/2026
+"""
+import argparse
+import struct
+import sys
+
+MAGIC = b"ALOG"
+SUPPORTED_VERSION = 2
+AXES = "xyz"
+
+def read_dump(stream) -> bytes:
+    """Waits for the start of a dump and returns the header and records.
+
+    Args:
+        stream: object with a read(n) method (serial port or file).
+
+    Returns:
+        bytes: the version, record count, record size and records.
+    """
+    # Find the start
+    window = b""
+    while window != MAGIC:
+        byte = stream.read(1)
+        if not byte:
+            raise EOFError("Could not find the start of the log")
+        window = (window + byte)[-len(MAGIC):]
+
+    header = stream.read(3)
+    _, count, size = header
+    return header + stream.read(count * size)
+
+def crc_xmodem(data: bytes) -> int:
+    """Calculates the CRC-16/XMODEM of some data (_crc_xmodem_update in avr-libc)."""
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xffff
+    return crc
+
+def decode(data: bytes) -> list:
+    """Decodes the records from a dump.
+
+    Args:
+        data (bytes): the output of read_dump.
+
+    Returns:
+        list: a dictionary for each record with a valid CRC, oldest first.
+    """
+    version, count, size = data[:3]
+    if version != SUPPORTED_VERSION:
+        raise ValueError("Unsupported log version {}".format(version))
+
+    changes = (size - 8) // 3 // 2 - 4 # Each axis has n changes and 2 floats.
+    axis_format = "{}hff".format(changes)
+    record_format = "<BBI" + axis_format * 3 + "H"
+    records = []
+    for i in range(count):
+        raw = data[3 + i*size:3 + (i+1)*size]
+        fields = struct.unpack(record_format, raw)
+        sequence, axes, armed_time = fields[:3]
+        if fields[-1] != crc_xmodem(bytes([version]) + raw[:-2]):
+            continue # Empty, partly written or something else was stored here
+
+        record = {"sequence": sequence, "axes": axes, "armed_time": armed_time / 1000, "axis": {}}
+        for j, name in enumerate(AXES):
+            start = 3 + j*(changes + 2)
+            record["axis"][name] = {
+                "changes": list(fields[start:start + changes]),
+                "mean": fields[start + changes],
+                "std": fields[start + changes + 1]
+            }
+        records.append(record)
+
+    # Sort oldest to newest, coping with the sequence number wrapping around.
+    records.sort(key=lambda r: r["sequence"])
+    for i in range(1, len(records)):
+        if records[i]["sequence"] - records[i-1]["sequence"] > count:
+            records = records[i:] + records[:i]
+            break
+    return records
+
+def print_records(records: list) -> None:
+    """Prints the records as a table."""
+    if not records:
+        print("The log is empty")
+    for record in records:
+        tripped = ", ".join(a for i, a in enumerate(AXES) if record["axes"] & (1 << i))
+        print("Trigger {} after {:.1f}s armed. Tripped: {}".format(record["sequence"], record["armed_time"], tripped))
+        for name, axis in record["axis"].items():
+            print("    {}: changes {}, mean {:.2f}, std {:.2f}".format(name, axis["changes"], axis["mean"], axis["std"]))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Decodes the burgler alarm trigger log")
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("-p", "--port", help="Serial port the horn is connected to")
+    group.add_argument("-f", "--file", help="File containing a saved binary dump")
+    parser.add_argument("-b", "--baud", type=int, default=38400, help="Serial baud rate (SERIAL_BAUD in defines.h)")
+    parser.add_argument("-s", "--save", help="Also save the binary dump to this file")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud) as port:
+            print("Waiting for the log. Select it from the horn's menu.", file=sys.stderr)
+            data = read_dump(port)
+    else:
+        with open(args.file, "rb") as f:
+            data = read_dump(f)
+
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(MAGIC + data)
+
+    print_records(decode(data))
\ No newline at end of file
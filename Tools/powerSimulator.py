@@ -0,0 +1,457 @@
+#!/usr/bin/env python3
+"""powerSimulator.py
+Estimates how long the horn's batteries will last for a given usage profile.
+
+The horn's states (asleep, riding, awake, playing, the menu and the burgler
+alarm states) are modelled using the timing settings and the CURRENT_* current model
+read straight from defines.h and alarmSettings.h, so the energy cost of a change
+to a setting can be seen before riding with it. Settings can also be overridden
+on the command line to compare them.
+
+For more details, see Documentation/PowerSimulator.md or go to
+https://github.com/jgOhYeah/BikeHorn
+
+Written by Jotham Gates
+Created 18/10/2026
+Last modified 18/10/2026
+"""
+import argparse
+import bisect
+import heapq
+import os
+import random
+import re
+
+FIRMWARE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "BikeHorn")
+HEADERS = ["defines.h", os.path.join("src", "clock.h"), os.path.join("src", "extensions", "burglerAlarm", "alarmSettings.h")]
+
+# Nominal watchdog periods for each period_t in ms (sleepPeriods in burglerAlarm.cpp).
+SLEEP_PERIODS = ["SLEEP_15MS", "SLEEP_30MS", "SLEEP_60MS", "SLEEP_120MS", "SLEEP_250MS", "SLEEP_500MS", "SLEEP_1S", "SLEEP_2S", "SLEEP_4S", "SLEEP_8S"]
+SLEEP_TIMES = [15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000]
+ALARM_CYCLE = 0.25 # SLEEP_250MS between samples in the init, awake and alert states (s).
+F_CPU = 16000000
+PERIPHERALS = ["adc", "usart", "spi", "timer1", "timer2", "twi"] # Can be switched off in PRR (PowerDomain in power.h).
+
+def parse_defines(paths: list, overrides: dict) -> dict:
+    """Reads the numeric #defines from the given headers.
+
+    Only the first definition of each name is used, as in the #ifndef blocks in
+    alarmSettings.h. Names of watchdog periods (SLEEP_1S, ...) are converted to
+    their period_t values. Flags without a value (ENABLE_CLOCK_SCALING, ...) are
+    given the value 1. Anything else that is not a number is ignored.
+
+    Args:
+        paths (list): the headers to read.
+        overrides (dict): name to value strings that replace the headers' values.
+                          None removes the name (#undef).
+
+    Returns:
+        dict: name to value.
+    """
+    raw = {}
+    pattern = re.compile(r"^\s*#define\s+(\w+)(?:\s+(\S.*))?$")
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                match = pattern.match(line.split("//")[0].rstrip())
+                if match and match.group(1) not in raw:
+                    raw[match.group(1)] = (match.group(2) or "1").strip()
+    raw.update(overrides)
+    raw = {name: value for name, value in raw.items() if value is not None}
+
+    values = {}
+    def evaluate(name, seen=()):
+        if name in values:
+            return values[name]
+        if name in SLEEP_PERIODS:
+            return SLEEP_PERIODS.index(name)
+        if name not in raw or name in seen:
+            raise ValueError(name)
+        expression = re.sub(r"\b(\d+)[UL]+\b", r"\1", raw[name])
+        expression = re.sub(r"\b[A-Za-z_]\w*\b", lambda m: str(evaluate(m.group(0), seen + (name,))), expression)
+        if not re.fullmatch(r"[\d\s+\-*/()x.a-fA-F]+", expression):
+            raise ValueError(name)
+        values[name] = eval(expression)
+        return values[name]
+
+    for name in raw:
+        try:
+            evaluate(name)
+        except (ValueError, SyntaxError):
+            pass
+    return values
+
+class Ledger():
+    """Adds up the time spent and charge used by each state."""
+    def __init__(self):
+        self.states = {}
+
+    def add(self, state: str, time: float, current: float) -> float:
+        """Records time spent in a state.
+
+        Args:
+            state (str): the name of the state.
+            time (float): the time spent in s.
+            current (float): the current drawn in uA.
+
+        Returns:
+            float: the time spent (so calls can be added up).
+        """
+        record = self.states.setdefault(state, [0, 0])
+        record[0] += time
+        record[1] += time * current / 3.6e6 # mAh
+        return time
+
+    def charge(self) -> float:
+        """Returns the total charge used in mAh"""
+        return sum(record[1] for record in self.states.values())
+
+    def time(self) -> float:
+        """Returns the total time in s"""
+        return sum(record[0] for record in self.states.values())
+
+class Horn():
+    """Model of the firmware. Each method runs one thing the horn can be asked
+    to do and returns how long it took."""
+    def __init__(self, defines: dict, args):
+        self.d = defines
+        self.args = args
+        self.ledger = Ledger()
+
+        # Current model
+        self.active = defines["CURRENT_ACTIVE"]
+        self.active_slow = defines["CURRENT_ACTIVE_SLOW"] if "ENABLE_CLOCK_SCALING" in defines else self.active
+        self.power_down = defines["CURRENT_POWER_DOWN"]
+        self.adc = defines["CURRENT_ADC"]
+        self.accelerometer = defines["CURRENT_ACCELEROMETER"]
+        self.boost = defines["CURRENT_BOOST"]
+        self.sound = defines["CURRENT_SOUND"]
+        self.boost_idle = self.boost * defines["IDLE_DUTY"] / (args.play_duty / 100 * 255) # Assumes the boost current is proportional to its duty cycle
+        self.boost_timeout = defines["BOOST_IDLE_TIMEOUT"] * 1.024e-3 # Timer 0 ticks to s
+        self.settle = args.settle / 1000 if args.settle is not None else SLEEP_TIMES[defines["ACCEL_SETTLE_MAX"]] / 1000
+
+        # ClockManager::slow() only slows the clock while waiting with serial
+        # on if UBRR0 + 1 can be divided by CLOCK_SLOW_DIVISION (as
+        # HardwareSerial::begin() calculates it). Serial is off while the alarm
+        # sleeps.
+        ubrr = (F_CPU // 4 // defines["SERIAL_BAUD"] - 1) // 2
+        self.waiting_slow = "ENABLE_CLOCK_SCALING" in defines and (ubrr + 1) % defines["CLOCK_SLOW_DIVISION"] == 0
+        self.waiting = self.active_slow if self.waiting_slow else self.active
+
+        # Ride detection (RideDetector in rideDetector.h)
+        self.ride_detection = "ENABLE_RIDE_DETECTION" in defines
+        self.rides = [] # Sorted, non overlapping (start, end) times the bike is ridden in s. Set by simulate().
+        self.score = 0
+        self.riding = False
+        self.primed = False
+        self.quiet = 0
+
+    def sleep(self, start: float, time: float) -> float:
+        """Asleep until a button is pressed. Without ENABLE_RIDE_DETECTION, this
+        is SLEEP_FOREVER. With it, the accelerometer is sampled as in
+        RideDetector::sleep(), idling with the boost stage warm while riding.
+
+        Args:
+            start (float): the time the horn went to sleep in s.
+            time (float): the time until the button is pressed in s.
+        """
+        if not self.ride_detection:
+            return self.ledger.add("Power down", time, self.power_down)
+
+        now = start
+        end = start + time
+        while now < end:
+            if self.riding:
+                domains = ("timer2",)
+                state, period, current = "Riding", self.d["RIDE_SAMPLE_PERIOD"], self.args.idle_current + self.boost_idle + self._peripherals(*domains)
+            elif self.quiet < self.d["RIDE_DEEP_SLEEP_SAMPLES"]:
+                domains = ()
+                state, period, current = "Parked", self.d["RIDE_PARKED_PERIOD"], self.power_down
+            else:
+                self.ledger.add("Power down", end - now, self.power_down)
+                break
+
+            period = SLEEP_TIMES[period] / 1000
+            if now + period + self.settle + self.args.sample_time / 1000 > end:
+                # Woken up by the button before the next sample.
+                self.ledger.add(state, end - now, current)
+                break
+            now += self.ledger.add(state, period, current)
+            now += self.ledger.add(state, self.settle, current + self.accelerometer)
+            now += self.ledger.add(state, self.args.sample_time / 1000, self.active + self._peripherals("adc", *domains) + self.adc + self.accelerometer)
+            self._ride_sample(self._moving(now))
+        return time
+
+    def horn_press(self, length: float) -> float:
+        """Plays the current tune while the horn button is held. The boost
+        stage idles while going back to sleep afterwards."""
+        self._button(True)
+        time = self._wake(warm=True)
+        playing = length + self.d["DEBOUNCE_TIME"] / 1000
+        rests = playing * self.args.rest_fraction
+        time += self.ledger.add("Playing", playing - rests, self.active + self._peripherals("usart", "timer1", "timer2") + self.boost + self.sound)
+        time += self.ledger.add("Boost idle", rests, self.active + self._peripherals("usart", "timer2") + self.boost_idle)
+        return time
+
+    def tune_change(self) -> float:
+        """Short press of the mode button."""
+        self._button(False)
+        time = self._wake()
+        time += self.ledger.add("Awake", self.args.mode_press + self.d["DEBOUNCE_TIME"] / 1000, self._waiting())
+        return time
+
+    def menu(self) -> float:
+        """Long press of the mode button, then leaving the menu to time out."""
+        self._button(False)
+        time = self._wake()
+        time += self.ledger.add("Menu", (self.d["LONG_PRESS_TIME"] + self.d["DEBOUNCE_TIME"]) / 1000, self._waiting())
+        time += self._beep("Menu")
+        time += self._awake("Menu", self.d["MENU_TIMEOUT"] / 1000)
+        time += self._beep("Menu")
+        return time
+
+    def alarm(self, length: float, disturbances: list) -> float:
+        """Arms the burgler alarm for a given time.
+
+        Args:
+            length (float): the time until the alarm is disarmed in s.
+            disturbances (list): sorted times after arming when the bike is
+                                 bumped enough to wake the alarm up.
+        """
+        # StateInit
+        time = 0
+        for _ in range(self.d["PREVIOUS_RECORDS"]):
+            time += self._alarm_cycle("Alarm init", self.active + self._peripherals("usart", "adc"))
+        time += self._beep("Alarm init")
+
+        # StateSleep, waking up to StateAwake and StateAlert when disturbed.
+        period = self.d["SLEEP_PERIOD_MIN"]
+        quiet = 0
+        index = 0
+        while time < length:
+            time += self.ledger.add("Alarm sleep", SLEEP_TIMES[period] / 1000, self.power_down)
+            time += self.ledger.add("Alarm sleep", self.settle, self.power_down + self.accelerometer)
+            time += self.ledger.add("Alarm sleep", self.args.sample_time / 1000, self.active_slow + self._peripherals("adc", slow="ENABLE_CLOCK_SCALING" in self.d) + self.adc + self.accelerometer)
+            if index < len(disturbances) and disturbances[index] <= time:
+                # Moved. Anything else that happens while awake is ignored.
+                for _ in range(self.d["IGNORE_CYCLES"]):
+                    time += self._alarm_cycle("Alarm awake", self._waiting("adc"))
+                for _ in range(self.d["ALERT_CYCLES"]):
+                    time += self._alarm_cycle("Alarm alert", self._waiting("adc"))
+                while index < len(disturbances) and disturbances[index] <= time:
+                    index += 1
+                period = self.d["SLEEP_PERIOD_MIN"]
+                quiet = 0
+            else:
+                quiet += 1
+                if quiet >= self.d["SLEEP_QUIET_SAMPLES"]:
+                    quiet = 0
+                    period = min(period + 1, self.d["SLEEP_PERIOD_MAX"])
+
+        # StateCountdown while the code is entered
+        time += self.ledger.add("Alarm disarm", self.args.disarm_time, self.active + self._peripherals("usart", "timer1", "timer2") + self.boost + self.sound)
+        return time
+
+    def _button(self, horn: bool) -> None:
+        """Updates the ride detector after being woken by a button. The horn
+        button means the bike is probably being ridden."""
+        self.quiet = 0
+        if horn:
+            self.score = max(self.score, self.d["RIDE_SCORE_RIDING"])
+            self.riding = True
+
+    def _moving(self, time: float) -> bool:
+        """Returns True if the bike is being ridden at the given time."""
+        index = bisect.bisect(self.rides, (time, float("inf"))) - 1
+        return index >= 0 and time < self.rides[index][1]
+
+    def _ride_sample(self, moved: bool) -> None:
+        """Updates the score as in RideDetector::m_update(). The first sample
+        only primes the previous reading."""
+        if not self.primed:
+            self.primed = True
+            return
+        if moved:
+            self.score = min(self.score + self.d["RIDE_SCORE_MOVED"], self.d["RIDE_SCORE_MAX"])
+            self.quiet = 0
+        else:
+            self.score = max(self.score - 1, 0)
+            self.quiet = min(self.quiet + 1, 255)
+        if (self.score == 0) if self.riding else (self.score >= self.d["RIDE_SCORE_RIDING"]):
+            self.riding = not self.riding
+            self.quiet = 0
+
+    def _wake(self, warm: bool = False) -> float:
+        """Waking up and going back to sleep (serial messages and extension
+        hooks). The boost stage is stopped when going to sleep, so it only
+        idles for this long if warm is True."""
+        return self._awake("Awake", self.args.wake_time / 1000, warm, self.active + self._peripherals("usart"))
+
+    def _awake(self, state: str, time: float, warm: bool = True, current: float = None) -> float:
+        """Awake and waiting (with the clock slowed if the baud rate allows it,
+        unless current is given). If warm (straight after a beep or a tune),
+        the boost stage idles at IDLE_DUTY until BOOST_IDLE_TIMEOUT first, which
+        keeps the clock at full speed."""
+        idle = min(self.boost_timeout, time) if warm else 0
+        if idle:
+            self.ledger.add("Boost idle", idle, self.active + self._peripherals("usart", "timer2") + self.boost_idle)
+        return idle + self.ledger.add(state, time - idle, self._waiting() if current is None else current)
+
+    def _beep(self, state: str) -> float:
+        """A UI beep. The boost stage is started for these like any other
+        sound."""
+        return self.ledger.add(state, self.args.beep_time, self.active + self._peripherals("usart", "timer1", "timer2") + self.boost + self.sound)
+
+    def _peripherals(self, *domains, slow: bool = False) -> float:
+        """Returns the extra current drawn while the CPU is running by the
+        given peripherals, which PowerManager switches on in PRR. All of them
+        are counted with --no-prr. Scaled down with the clock if slow."""
+        count = len(PERIPHERALS) if self.args.no_prr else len(domains)
+        current = count * self.args.peripheral_current
+        return current / self.d["CLOCK_SLOW_DIVISION"] if slow else current
+
+    def _waiting(self, *domains) -> float:
+        """Returns the current while waiting with serial on (slowed down if the
+        baud rate allows it) and the given peripherals on."""
+        return self.waiting + self._peripherals("usart", *domains, slow=self.waiting_slow)
+
+    def _alarm_cycle(self, state: str, active: float) -> float:
+        """One SLEEP_250MS cycle with the accelerometer and ADC on, then a
+        sample with the CPU drawing active."""
+        time = self.ledger.add(state, ALARM_CYCLE, self.power_down + self.adc + self.accelerometer)
+        time += self.ledger.add(state, self.args.sample_time / 1000, active + self.adc + self.accelerometer)
+        return time
+
+def simulate(horn: Horn, args) -> dict:
+    """Replays the usage profile for the given number of days.
+
+    Each day, the alarm is armed for args.armed_hours starting at midnight. The
+    rest of the day is split into args.rides equal slots with a ride at a random
+    time in each. Horn presses happen at random times during the rides (or the
+    rest of the day if there are none) and the other button presses at random
+    times during the rest of the day. Events are handled in time order and
+    anything that happens while the horn is busy waits until it has finished.
+
+    Returns:
+        dict: event name to [count, charge in mAh].
+    """
+    rng = random.Random(args.seed)
+    day = 24 * 3600
+    armed = args.armed_hours * 3600
+    events = []
+    for d in range(args.days):
+        start = d * day
+        if armed:
+            # Bumps arrive randomly (a Poisson process)
+            bumps = []
+            bump = rng.expovariate(args.disturbances / 3600) if args.disturbances else armed
+            while bump < armed:
+                bumps.append(bump)
+                bump += rng.expovariate(args.disturbances / 3600)
+            heapq.heappush(events, (start, "Alarm", (armed, bumps)))
+        rides = []
+        if args.rides:
+            slot = (day - armed) / args.rides
+            length = min(args.ride_length * 60, slot)
+            for r in range(args.rides):
+                ride = start + armed + r * slot + rng.uniform(0, slot - length)
+                rides.append((ride, ride + length))
+        horn.rides.extend(rides)
+        for _ in range(args.presses):
+            if rides:
+                ride = rng.choice(rides)
+                time = rng.uniform(*ride)
+            else:
+                time = start + rng.uniform(armed, day)
+            heapq.heappush(events, (time, "Horn press", rng.expovariate(1 / args.press_length)))
+        for _ in range(args.tune_changes):
+            heapq.heappush(events, (start + rng.uniform(armed, day), "Tune change", None))
+        for _ in range(args.menus):
+            heapq.heappush(events, (start + rng.uniform(armed, day), "Menu timeout", None))
+
+    costs = {}
+    now = 0
+    end = args.days * day
+    while events:
+        time, name, data = heapq.heappop(events)
+        if time > now:
+            horn.sleep(now, time - now)
+            now = time
+
+        before = horn.ledger.charge()
+        if name == "Alarm":
+            now += horn.alarm(*data)
+        elif name == "Horn press":
+            now += horn.horn_press(data)
+        elif name == "Tune change":
+            now += horn.tune_change()
+        else:
+            now += horn.menu()
+        cost = costs.setdefault(name, [0, 0])
+        cost[0] += 1
+        cost[1] += horn.ledger.charge() - before
+
+    if end > now:
+        horn.sleep(now, end - now)
+    return costs
+
+def print_results(horn: Horn, costs: dict, args) -> None:
+    """Prints where the charge went and the estimated battery life."""
+    ledger = horn.ledger
+    total_charge = ledger.charge()
+    total_time = ledger.time()
+    print("{:<14}{:>12}{:>14}{:>8}{:>14}".format("State", "Time (h)", "Charge (mAh)", "Share", "Average (uA)"))
+    for state, (time, charge) in sorted(ledger.states.items(), key=lambda s: -s[1][1]):
+        print("{:<14}{:>12.3f}{:>14.3f}{:>7.1f}%{:>14.1f}".format(state, time / 3600, charge, charge / total_charge * 100, charge * 3.6e6 / time if time else 0))
+
+    print()
+    print("{:<14}{:>8}{:>18}".format("Event", "Count", "Each (uAh)"))
+    for name, (count, charge) in costs.items():
+        print("{:<14}{:>8}{:>18.2f}".format(name, count, charge / count * 1000))
+
+    average = total_charge * 3.6e6 / total_time
+    self_discharge = args.capacity * args.self_discharge / 100 / (365 * 24) * 1000 # Treated as a constant extra current in uA
+    days = args.capacity / ((average + self_discharge) / 1000) / 24
+    print()
+    print("Average current: {:.1f} uA (plus {:.1f} uA of self discharge)".format(average, self_discharge))
+    print("Battery life: {:.0f} days ({:.1f} months) from {} mAh".format(days, days / 30.4, args.capacity))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Estimates the horn's battery life from a usage profile")
+    profile = parser.add_argument_group("usage profile (per day)")
+    profile.add_argument("--presses", type=int, default=20, help="Horn button presses (default 20)")
+    profile.add_argument("--press-length", type=float, default=1, help="Average horn press length in s (default 1)")
+    profile.add_argument("--rides", type=int, default=2, help="Rides, during which the horn presses happen (default 2)")
+    profile.add_argument("--ride-length", type=float, default=30, help="Length of each ride in minutes (default 30)")
+    profile.add_argument("--tune-changes", type=int, default=1, help="Short presses of the mode button (default 1)")
+    profile.add_argument("--menus", type=int, default=0, help="Times the menu is opened and left to time out (default 0)")
+    profile.add_argument("--armed-hours", type=float, default=0, help="Hours the burgler alarm is armed for (default 0)")
+    profile.add_argument("--disturbances", type=float, default=1, help="Bumps per armed hour that wake the alarm (default 1)")
+
+    model = parser.add_argument_group("horn model")
+    model.add_argument("--capacity", type=float, default=2000, help="Battery capacity in mAh (default 2000)")
+    model.add_argument("--self-discharge", type=float, default=2, help="Battery self discharge in %% of the capacity per year (default 2)")
+    model.add_argument("--play-duty", type=float, default=50, help="Typical boost duty cycle while playing in %% (default 50)")
+    model.add_argument("--rest-fraction", type=float, default=0.1, help="Fraction of playing time spent in rests with the boost at IDLE_DUTY (default 0.1)")
+    model.add_argument("--idle-current", type=float, default=3000, help="Current drawn in idle mode at 16MHz with timer 0 off in uA (default 3000)")
+    model.add_argument("--peripheral-current", type=float, default=100, help="Extra current for each peripheral switched on in PRR while the CPU runs at 16MHz in uA (default 100)")
+    model.add_argument("--no-prr", action="store_true", help="Leave every peripheral switched on, as before PowerManager")
+    model.add_argument("--wake-time", type=float, default=5, help="Time awake to wake up and go back to sleep in ms (default 5)")
+    model.add_argument("--mode-press", type=float, default=0.3, help="Short mode button press length in s (default 0.3)")
+    model.add_argument("--beep-time", type=float, default=0.2, help="Length of a UI beep in s (default 0.2)")
+    model.add_argument("--sample-time", type=float, default=1, help="Time awake to read the accelerometer in ms (default 1)")
+    model.add_argument("--settle", type=float, help="Calibrated accelerometer settle time in ms (default ACCEL_SETTLE_MAX)")
+    model.add_argument("--disarm-time", type=float, default=5, help="Time to enter the code to disarm the alarm in s (default 5)")
+
+    parser.add_argument("-D", "--define", action="append", default=[], metavar="NAME[=VALUE]", help="Override a setting from defines.h or alarmSettings.h")
+    parser.add_argument("-U", "--undefine", action="append", default=[], metavar="NAME", help="Remove a setting, for example -U ENABLE_CLOCK_SCALING")
+    parser.add_argument("--days", type=int, default=30, help="Number of days to simulate (default 30)")
+    parser.add_argument("--seed", type=int, default=0, help="Random seed (default 0)")
+    args = parser.parse_args()
+
+    overrides = dict((define.split("=", 1) + ["1"])[:2] for define in args.define)
+    overrides.update((name, None) for name in args.undefine)
+    defines = parse_defines([os.path.join(FIRMWARE, header) for header in HEADERS], overrides)
+    horn = Horn(defines, args)
+    costs = simulate(horn, args)
+    print_results(horn, costs, args)
\ No newline at end of file
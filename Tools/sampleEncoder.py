@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""sampleEncoder.py
+Converts a wav file into IMA ADPCM arrays that can be pasted into samples.h
+and played through the horn's piezo.
+
+The sound is mixed down to mono, resampled to one of the rates the horn can
+play (62.5kHz divided by 4 to 8), normalised and encoded to 4 bits per sample.
+Use --preview to save what the horn should sound like.
+
+For more details, see Documentation/Samples.md or go to
+https://github.com/jgOhYeah/BikeHorn
+
+Written by Jotham Gates
+Created 18/10/2026
+Last modified 18/10/2026
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+import wave
+
+CARRIER = 16000000 // 256 # SAMPLE_CARRIER in samplePlayer.h
+DIVIDERS = range(4, 9)
+MAX_FLASH = 8192 # Warn if a sample is bigger than this in bytes.
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+]
+INDEX_CHANGES = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+def read_wav(filename:str) -> tuple:
+    """Reads a wav file and mixes it down to mono.
+
+    Args:
+        filename (str): the file to read.
+
+    Returns:
+        tuple: (sample rate in Hz, list of samples from -1 to 1).
+    """
+    with wave.open(filename, "rb") as file:
+        channels = file.getnchannels()
+        width = file.getsampwidth()
+        rate = file.getframerate()
+        frames = file.readframes(file.getnframes())
+
+    if width == 1:
+        values = [(byte - 128) / 128 for byte in frames] # 8 bit wav files are unsigned
+    elif width == 2:
+        values = [value / 32768 for value in struct.unpack("<{}h".format(len(frames) // 2), frames)]
+    else:
+        raise ValueError("Only 8 and 16 bit wav files are supported")
+
+    mono = [sum(values[i:i + channels]) / channels for i in range(0, len(values), channels)]
+    return rate, mono
+
+def resample(samples:list, old_rate:float, new_rate:float) -> list:
+    """Resamples using linear interpolation. When downsampling, a moving
+    average is applied first to reduce aliasing.
+
+    Args:
+        samples (list): the samples.
+        old_rate (float): the current sample rate in Hz.
+        new_rate (float): the wanted sample rate in Hz.
+
+    Returns:
+        list: the resampled samples.
+    """
+    ratio = old_rate / new_rate
+    width = int(ratio)
+    if width > 1:
+        total = 0
+        filtered = []
+        for i, sample in enumerate(samples):
+            total += sample
+            if i >= width:
+                total -= samples[i - width]
+            filtered.append(total / min(i + 1, width))
+        samples = filtered
+
+    result = []
+    position = 0
+    while position < len(samples) - 1:
+        i = int(position)
+        fraction = position - i
+        result.append(samples[i] * (1 - fraction) + samples[i + 1] * fraction)
+        position += ratio
+    return result
+
+def normalise(samples:list, gain:float) -> list:
+    """Scales the samples so the loudest is at full scale, then applies a gain.
+
+    Args:
+        samples (list): the samples.
+        gain (float): extra gain in dB. Anything louder than full scale is
+                      clipped.
+
+    Returns:
+        list: the samples as 16 bit integers.
+    """
+    peak = max(abs(sample) for sample in samples) or 1
+    scale = 32767 / peak * 10 ** (gain / 20)
+    return [max(-32768, min(32767, round(sample * scale))) for sample in samples]
+
+def starting_index(samples:list) -> int:
+    """Picks a step index that suits the start of the sample.
+
+    Args:
+        samples (list): the samples as 16 bit integers.
+
+    Returns:
+        int: the index.
+    """
+    if len(samples) < 2:
+        return 0
+    difference = abs(samples[1] - samples[0])
+    index = 0
+    while index < len(STEPS) - 1 and STEPS[index] < difference:
+        index += 1
+    return index
+
+def decode_code(code:int, predictor:int, index:int) -> tuple:
+    """Decodes a single code the same way as SamplePlayer::update().
+
+    Args:
+        code (int): the 4 bit code.
+        predictor (int): the previous output.
+        index (int): the current step index.
+
+    Returns:
+        tuple: (output, new step index).
+    """
+    step = STEPS[index]
+    difference = step >> 3
+    if code & 4:
+        difference += step
+    if code & 2:
+        difference += step >> 1
+    if code & 1:
+        difference += step >> 2
+    if code & 8:
+        predictor = max(-32768, predictor - difference)
+    else:
+        predictor = min(32767, predictor + difference)
+    index = max(0, min(len(STEPS) - 1, index + INDEX_CHANGES[code & 7]))
+    return predictor, index
+
+def encode(samples:list, index:int) -> list:
+    """Encodes samples as 4 bit IMA ADPCM codes.
+
+    Args:
+        samples (list): the samples as 16 bit integers.
+        index (int): the starting step index.
+
+    Returns:
+        list: the codes.
+    """
+    predictor = 0
+    codes = []
+    for sample in samples:
+        step = STEPS[index]
+        difference = sample - predictor
+        code = 0
+        if difference < 0:
+            code = 8
+            difference = -difference
+        if difference >= step:
+            code |= 4
+            difference -= step
+        if difference >= step >> 1:
+            code |= 2
+            difference -= step >> 1
+        if difference >= step >> 2:
+            code |= 1
+
+        # Track the decoder so that errors don't build up.
+        predictor, index = decode_code(code, predictor, index)
+        codes.append(code)
+    return codes
+
+def decode(codes:list, index:int) -> list:
+    """Decodes codes to 8 bit levels as the horn would output them.
+
+    Args:
+        codes (list): the 4 bit codes.
+        index (int): the starting step index.
+
+    Returns:
+        list: the levels (0 to 255).
+    """
+    predictor = 0
+    levels = []
+    for code in codes:
+        predictor, index = decode_code(code, predictor, index)
+        levels.append(((predictor >> 8) + 128) & 0xff)
+    return levels
+
+def pack(codes:list) -> bytes:
+    """Packs 2 codes per byte, low nibble first.
+
+    Args:
+        codes (list): the 4 bit codes.
+
+    Returns:
+        bytes: the packed codes.
+    """
+    if len(codes) % 2:
+        codes = codes + [0]
+    return bytes(codes[i] | (codes[i + 1] << 4) for i in range(0, len(codes), 2))
+
+def c_source(name:str, source:str, data:bytes, length:int, divider:int, index:int) -> str:
+    """Generates the arrays for samples.h.
+
+    Args:
+        name (str): the name of the sample.
+        source (str): the file the sample was converted from.
+        data (bytes): the packed codes.
+        length (int): the number of samples.
+        divider (int): the carrier cycles per sample.
+        index (int): the starting step index.
+
+    Returns:
+        str: the code.
+    """
+    rate = CARRIER / divider
+    lines = [
+        "// Converted from '{}' by sampleEncoder.py. {:.2f}s at {:.0f}Hz, {} bytes.".format(
+            source, length / rate, rate, len(data)
+        ),
+        "const uint8_t {}Data[] PROGMEM = {{".format(name)
+    ]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ",".join("0x{:02x}".format(byte) for byte in data[i:i + 16]) + ",")
+    lines[-1] = lines[-1][:-1]
+    lines.append("};")
+    lines.append("const Sample {} PROGMEM = {{{}Data, {}, {}, {}}};".format(name, name, length, divider, index))
+    return "\n".join(lines)
+
+def save_preview(filename:str, levels:list, rate:int):
+    """Saves the decoded sample as an 8 bit wav file.
+
+    Args:
+        filename (str): the file to save to.
+        levels (list): the levels (0 to 255).
+        rate (int): the sample rate in Hz.
+    """
+    with wave.open(filename, "wb") as file:
+        file.setnchannels(1)
+        file.setsampwidth(1)
+        file.setframerate(rate)
+        file.writeframes(bytes(levels))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Converts a wav file to an ADPCM sample for the horn")
+    parser.add_argument("file", help="8 or 16 bit wav file to convert")
+    parser.add_argument("-n", "--name", help="Name of the sample in the code (defaults to the file name)")
+    parser.add_argument("-d", "--divider", type=int, choices=DIVIDERS, default=6,
+                        help="Carrier cycles per sample. 4 is {:.0f}Hz, 8 is {:.0f}Hz".format(CARRIER / 4, CARRIER / 8))
+    parser.add_argument("-g", "--gain", type=float, default=0, help="Gain in dB after normalising. Clips if above 0")
+    parser.add_argument("-o", "--output", help="File to write the code to instead of the console")
+    parser.add_argument("-p", "--preview", help="Also save what the horn should play to this wav file")
+    args = parser.parse_args()
+
+    name = args.name or re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.file))[0])
+    rate, samples = read_wav(args.file)
+    new_rate = CARRIER / args.divider
+    samples = normalise(resample(samples, rate, new_rate), args.gain)
+    index = starting_index(samples)
+    codes = encode(samples, index)
+    data = pack(codes)
+    code = c_source(name, os.path.basename(args.file), data, len(codes), args.divider, index)
+
+    if args.output:
+        with open(args.output, "w") as file:
+            file.write(code + "\n")
+    else:
+        print(code)
+
+    if args.preview:
+        save_preview(args.preview, decode(codes, index), round(new_rate))
+
+    if len(data) > MAX_FLASH:
+        print("Warning: the sample is {} bytes. Consider trimming it or using a bigger divider".format(len(data)),
+              file=sys.stderr)
\ No newline at end of file
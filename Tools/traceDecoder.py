@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""traceDecoder.py
+Reads the trace events recorded by the horn when ENABLE_TRACE is defined and
+prints them as a timeline.
+
+Select "Dump trace events" from the horn's menu while this script is running.
+The events can also be decoded from a file containing a saved dump.
+
+For more details, see Documentation/Tracing.md or go to
+https://github.com/jgOhYeah/BikeHorn
+
+Written by Jotham Gates
+Created 18/10/2026
+Last modified 18/10/2026
+"""
+import argparse
+import struct
+import sys
+
+MAGIC = b"TRCE"
+SUPPORTED_VERSION = 1
+
+# Must match TraceId in BikeHorn/src/trace.h
+EVENTS = [
+    "Sleep",
+    "Wake",
+    "Button",
+    "Boost start",
+    "Boost stop",
+    "Tune play",
+    "Note",
+    "Note stop",
+    "Ext onStart",
+    "Ext onWake",
+    "Ext onSleep",
+    "Ext onTuneStart",
+    "Ext onTuneStop",
+    "Ext hook done",
+    "EEPROM write",
+    "EEPROM done",
+    "Alarm state",
+    "Ext menu item"
+]
+BUTTONS = ["none", "horn", "mode"]
+STATES = ["Init", "Sleep", "Awake", "Alert", "Countdown", "Siren"]
+
+def read_dump(stream) -> bytes:
+    """Waits for the start of a dump and returns the header and events.
+
+    Args:
+        stream: object with a read(n) method (serial port or file).
+
+    Returns:
+        bytes: the version, us per tick, event count, event size and events.
+    """
+    # Find the start
+    window = b""
+    while window != MAGIC:
+        byte = stream.read(1)
+        if not byte:
+            raise EOFError("Could not find the start of the trace")
+        window = (window + byte)[-len(MAGIC):]
+
+    header = stream.read(4)
+    _, _, count, size = header
+    return header + stream.read(count * size)
+
+def describe(event_id: int, arg: int) -> str:
+    """Returns a readable description of an event's argument."""
+    name = EVENTS[event_id] if event_id < len(EVENTS) else "Unknown ({})".format(event_id)
+    if name in ("Wake", "Button"):
+        detail = BUTTONS[arg] if arg < len(BUTTONS) else str(arg)
+    elif name == "Tune play":
+        detail = "UI beep" if arg == 0xffff else "tune {}".format(arg)
+    elif name == "Note":
+        detail = "{} Hz".format(arg)
+    elif name.startswith("Ext on") or name == "Ext menu item":
+        detail = "extension {}".format(arg)
+    elif name == "Ext hook done":
+        detail = EVENTS[arg] if arg < len(EVENTS) else str(arg)
+    elif name == "EEPROM write":
+        detail = "address 0x{:03x}".format(arg)
+    elif name == "Alarm state":
+        detail = STATES[arg] if arg < len(STATES) else str(arg)
+    elif arg:
+        detail = str(arg)
+    else:
+        detail = ""
+    return "{:<16}{}".format(name, detail)
+
+def decode(data: bytes) -> list:
+    """Decodes the events from a dump.
+
+    Args:
+        data (bytes): the output of read_dump.
+
+    Returns:
+        list: (time in ms, event id, arg) tuples, oldest first.
+    """
+    version, us_per_tick, count, size = data[:4]
+    if version != SUPPORTED_VERSION:
+        raise ValueError("Unsupported trace version {}".format(version))
+
+    events = []
+    offset = 0
+    previous = 0
+    for i in range(count):
+        raw = data[4 + i*size:4 + (i+1)*size]
+        ticks, event_id, arg = struct.unpack("<IBH", raw)
+        if ticks < previous:
+            # The timestamp wrapped around (about every 4.8 hours at 16MHz).
+            offset += 1 << 32
+        previous = ticks
+        events.append(((ticks + offset) * us_per_tick / 1000, event_id, arg))
+    return events
+
+def print_timeline(events: list) -> None:
+    """Prints the events with the time since the first event and the previous
+    one."""
+    if not events:
+        print("No events recorded")
+        return
+    print("{:>12} {:>10}  {}".format("Time (ms)", "Delta (ms)", "Event"))
+    start = events[0][0]
+    previous = start
+    for time, event_id, arg in events:
+        print("{:12.3f} {:10.3f}  {}".format(time - start, time - previous, describe(event_id, arg)))
+        previous = time
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Decodes the horn's trace events into a timeline")
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("-p", "--port", help="Serial port the horn is connected to")
+    group.add_argument("-f", "--file", help="File containing a saved binary dump")
+    parser.add_argument("-b", "--baud", type=int, default=38400, help="Serial baud rate (SERIAL_BAUD in defines.h)")
+    parser.add_argument("-s", "--save", help="Also save the binary dump to this file")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud) as port:
+            print("Waiting for the trace. Select it from the horn's menu.", file=sys.stderr)
+            data = read_dump(port)
+    else:
+        with open(args.file, "rb") as f:
+            data = read_dump(f)
+
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(MAGIC + data)
+
+    print_timeline(decode(data))
@@ -6,7 +6,7 @@ For more details, see Readme.md or go to
 https://github.com/jgOhYeah/BikeHorn/tree/main/Tuning
 
 Written by Jotham Gates
-Last modified 28/02/2022
+Last modified 18/10/2026
 """
 # GUI libraries
 import tkinter as tk                    
@@ -26,6 +26,8 @@ from matplotlib.lines import Line2D
 import serial.tools.list_ports
 from serial.serialutil import SerialException
 import serial
+import binascii # For the CRC
+import struct
 
 # Sound
 import sounddevice as sd
@@ -49,7 +51,7 @@ import datetime
 # TODO: Semi - Random / non sequential order of testing
 
 name = "Bike Horn Optimiser Tool"
-version = "1.0.1"
+version = "1.1.0"
 
 # For python 3.6 (https://stackoverflow.com/a/52440947)
 class Spinbox(ttk.Entry):
@@ -264,13 +266,36 @@ class BikeHornInterface():
     TIMER_2_PRESCALAR = 1
     TIMER_2_TOP = 255
     EEPROM_SIZE = 1024
+
+    # Binary protocol (see OptimiserSketch.ino)
+    PROTOCOL_VERSION = 3
+    FRAME_SYNC = 0xa5
+    FRAME_MAX_PAYLOAD = 64
+    COMMAND_PLAY = 'p'
+    COMMAND_STOP = 's'
+    COMMAND_WRITE = 'w'
+    COMMAND_READ = 'r'
+    COMMAND_SWEEP = 'x'
+    RESPONSE_READY = 'R'
+    RESPONSE_ACK = 'A'
+    RESPONSE_NAK = 'N'
+    RESPONSE_MARKER = 'M'
+    RESPONSE_COOLDOWN = 'C'
+    RESPONSE_DONE = 'D'
     
+    # EEPROM records (see recordStore.h and the EEPROM settings in defines.h)
+    EEPROM_RECORD_OVERHEAD = 5
     EEPROM_PIECEWISE_SIZE = 81
-    EEPROM_TIMER1_PIECEWISE = 0x35e
-    EEPROM_TIMER2_PIECEWISE = EEPROM_TIMER1_PIECEWISE + EEPROM_PIECEWISE_SIZE
+    EEPROM_TIMER2_PIECEWISE = EEPROM_SIZE - EEPROM_PIECEWISE_SIZE - EEPROM_RECORD_OVERHEAD
+    EEPROM_TIMER1_PIECEWISE = EEPROM_TIMER2_PIECEWISE - EEPROM_PIECEWISE_SIZE - EEPROM_RECORD_OVERHEAD
+    RECORD_TIMER1_PIECEWISE = 0
+    RECORD_TIMER2_PIECEWISE = 1
+    RECORD_PIECEWISE_VERSION = 1
     MAX_POINTS = 10
 
-    TEST_WAIT_TIME = 0.2
+    SERIAL_TIMEOUT = 10
+    TEST_SETTLE_TIME = 0.2 # Time to let things stabilise after starting each point (s)
+    TEST_DWELL_TIME = 0.3 # Time to play each point for, including the settling time (s)
     
     def __init__(self, logging, data_manager, audio=None, gui=None):
         self._serial_port = serial.Serial()
@@ -298,65 +323,89 @@ class BikeHornInterface():
         self._serial_port.port = port_name
         # self._serial_port.port = "/tmp/ttyV0" # For monitoring the serial port https://unix.stackexchange.com/a/225904
         self._serial_port.baudrate = BikeHornInterface.BAUD
-        self._serial_port.timeout = 10
+        self._serial_port.timeout = BikeHornInterface.SERIAL_TIMEOUT
             
-    def run_test(self, piezo_duty_values:Iterable, boost_duty_values:Iterable, midi_values:Iterable, cooldown_time:int=10):
-        """Runs the test
+    def run_test(self, piezo_duty_values:range, boost_duty_values:range, midi_values:range, cooldown_time:int=10):
+        """Runs the test.
+
+        The whole sweep is sent to the horn, which plays each point by itself and sends a marker as
+        each one starts. The audio level is recorded while this happens and lined up with the markers
+        afterwards, so the test is not slowed down by a serial round trip for each point.
 
         Args:
-            piezo_duty_values (Iterable): The values to test for the piezo duty cycle (%)
-            boost_duty_Values (Iterable): The values to test for the boost duty cycle (%)
-            midi_values (Iterable): The values to test for the midi note (0-127)
+            piezo_duty_values (range): The values to test for the piezo duty cycle (%)
+            boost_duty_Values (range): The values to test for the boost duty cycle (%)
+            midi_values (range): The values to test for the midi note (0-127)
+            cooldown_time (int, optional): The time to let the horn cool off between notes (s). Defaults to 10.
         """
         self._abort = False
-        sound_data = []
         
         if not self._start_serial_port():
             self.abort()
 
         if not self._abort:
             # Progress bar
-            total_steps = len(piezo_duty_values) * len(boost_duty_values) * len(midi_values)
-            total_time = total_steps*BikeHornInterface.TEST_WAIT_TIME + len(midi_values)*cooldown_time
+            points_per_note = len(piezo_duty_values) * len(boost_duty_values)
+            total_steps = points_per_note * len(midi_values)
+            total_time = total_steps*BikeHornInterface.TEST_DWELL_TIME + (len(midi_values) - 1)*cooldown_time
             self._logging.info("Running the test with {} points to test. This will take around {:.1f} minutes".format(total_steps, total_time/60))
-            current_step = 0
-
-            for midi in midi_values:
-                sound_midi_data = []
-                for boost in boost_duty_values:
-                    sound_boost_data = []
-                    for piezo in piezo_duty_values:
-                        # Progress bar stuff
-                        percent_done = current_step / total_steps * 100
-                        self._logging.info("MIDI Note: {}, Piezo: {}, Boost: {}, {:.1f}% done".format(midi, piezo, boost, percent_done))
-                        if self._gui:
-                            self._gui.update_test_progress(percent_done)
-                        
-                        # The actual communicating and testing part
-                        sound_boost_data.append(self._get_data_point(midi, boost, piezo))
-
-                        # Other housekeeping
-                        current_step += 1
-                        if self._abort:
-                            self._logging.info("Aborting the test")
-                            self._shutdown(False)
-                            return
 
-                    sound_midi_data.append(sound_boost_data)
-                
-                # Save and make a backup copy of the data
-                sound_data.append(sound_midi_data)
-                data_manager.set_sound_data(sound_data)
-                data_manager.save_data(backup=True)
-
-                # Let the horn cool off
-                self._logging.info("Stopping for {} second{} to let the horn cool off".format(cooldown_time, "s" if cooldown_time != 0 else ""))
-                self._shut_up()
-                time.sleep(cooldown_time)
-
-            # Finished the test successfully
-            self._logging.info("Finished the test successfully")
-            self._shutdown(success=True)
+            # Send the plan
+            plan = b"".join(bytes([r.start, len(r), r.step]) for r in (midi_values, boost_duty_values, piezo_duty_values))
+            plan += struct.pack("<HH", round(BikeHornInterface.TEST_DWELL_TIME * 1000), cooldown_time)
+            self._audio.start_recording()
+            if self._command(BikeHornInterface.COMMAND_SWEEP, plan) is None:
+                self._audio.stop_recording()
+                self._shutdown(False)
+                return
+
+            # Collect the markers as the horn plays the sweep
+            markers = [] # (device time (s), audio stream time (s)) for each point
+            device_time = TimeUnwrapper()
+            played = None
+            stop_sent = False
+            timeout = time.monotonic() + cooldown_time + BikeHornInterface.TEST_DWELL_TIME + 5
+            self._serial_port.timeout = 0.5
+            while played is None and time.monotonic() < timeout:
+                if self._abort and not stop_sent:
+                    self._logging.info("Aborting the test")
+                    self._send_frame(BikeHornInterface.COMMAND_STOP)
+                    stop_sent = True
+
+                frame = self._read_frame()
+                if frame is None:
+                    continue
+                now = self._audio.stream_time()
+                timeout = time.monotonic() + cooldown_time + BikeHornInterface.TEST_DWELL_TIME + 5
+                command, data = frame
+                if command == BikeHornInterface.RESPONSE_MARKER:
+                    index, micros, midi, boost, piezo = struct.unpack("<HIBBB", data)
+                    markers.append((device_time.unwrap(micros), now))
+                    percent_done = index / total_steps * 100
+                    self._logging.info("MIDI Note: {}, Piezo: {}, Boost: {}, {:.1f}% done".format(midi, piezo, boost, percent_done))
+                    if self._gui:
+                        self._gui.update_test_progress(percent_done)
+                elif command == BikeHornInterface.RESPONSE_COOLDOWN:
+                    # Save a backup of the notes so far
+                    self._data_manager.set_sound_data(self._sweep_results(markers, self._audio.get_recording(), points_per_note, len(boost_duty_values)))
+                    self._data_manager.save_data(backup=True)
+                    self._logging.info("Stopping for {} second{} to let the horn cool off".format(cooldown_time, "s" if cooldown_time != 1 else ""))
+                elif command == BikeHornInterface.RESPONSE_DONE:
+                    played = struct.unpack("<H", data[:2])[0]
+            self._serial_port.timeout = BikeHornInterface.SERIAL_TIMEOUT
+
+            # Line up the audio with the markers
+            recording = self._audio.stop_recording()
+            self._data_manager.set_sound_data(self._sweep_results(markers, recording, points_per_note, len(boost_duty_values)))
+            if played == total_steps:
+                # Finished the test successfully
+                self._logging.info("Finished the test successfully")
+                self._shutdown(success=True)
+            else:
+                if played is None:
+                    self._logging.error("Lost connection to horn - the sweep stopped sending markers")
+                self._logging.info("Only kept the results of the notes that were finished")
+                self._shutdown(False)
         else:
             self._shutdown(False)
 
@@ -394,12 +443,29 @@ class BikeHornInterface():
         
         self._logging.info("Starting upload")
         self._logging.info("Uploading timer 1 (piezo) config")
-        if self._send_config(BikeHornInterface.EEPROM_TIMER1_PIECEWISE, optimiser.get_t1_optimised().to_bytes()):
+        t1_record = BikeHornInterface.to_record(BikeHornInterface.RECORD_TIMER1_PIECEWISE, optimiser.get_t1_optimised().to_bytes())
+        if self._send_config(BikeHornInterface.EEPROM_TIMER1_PIECEWISE, t1_record):
             # Only procede on success of previous
             self._logging.info("Uploading timer 2 (boost) config")
-            if self._send_config(BikeHornInterface.EEPROM_TIMER2_PIECEWISE, optimiser.get_t2_optimised().to_bytes()):
+            t2_record = BikeHornInterface.to_record(BikeHornInterface.RECORD_TIMER2_PIECEWISE, optimiser.get_t2_optimised().to_bytes())
+            if self._send_config(BikeHornInterface.EEPROM_TIMER2_PIECEWISE, t2_record):
                 self._logging.info("Successfully finished upload")
     
+    @staticmethod
+    def to_record(record_type:int, payload:bytes, version:int=RECORD_PIECEWISE_VERSION) -> bytes:
+        """Wraps a payload in the header and CRC the horn checks before using it (see recordStore.h).
+
+        Args:
+            record_type (int): The type of record (RECORD_...).
+            payload (bytes): The data.
+            version (int, optional): The version of the payload format. Defaults to RECORD_PIECEWISE_VERSION.
+
+        Returns:
+            bytes: The record, ready to write to EEPROM.
+        """
+        data = bytes([record_type, version, len(payload)]) + payload
+        return data + binascii.crc_hqx(data, 0).to_bytes(2, "little") # CRC-16/XMODEM
+
     def dump_eeprom(self) -> str:
         """Dumps the eeprom and returns a table"""
         if not self._start_serial_port():
@@ -407,14 +473,23 @@ class BikeHornInterface():
             return
         
         self._logging.info("Requesting EEPROM dump")
-        self._serial_port.write("~`~`r`~`~".encode("UTF-8"))
-        response = self._serial_port.read_until("~`~`Ack`~`~".encode('UTF-8'))
-        if "~`~`Ack`~`~".encode("UTF-8") not in response:
-            self._logging.error("Something went wrong getting the EEPROM dump")
+        data = b""
+        while len(data) < BikeHornInterface.EEPROM_SIZE:
+            length = min(BikeHornInterface.FRAME_MAX_PAYLOAD, BikeHornInterface.EEPROM_SIZE - len(data))
+            block = self._command(BikeHornInterface.COMMAND_READ, struct.pack("<HB", len(data), length))
+            if block is None or len(block) != length:
+                self._logging.error("Something went wrong getting the EEPROM dump")
+                break
+            data += block
         else:
             self._logging.info("Got EEPROM dump successfully")
 
-        return response
+        # Format as a table
+        width = 16
+        lines = ["     | " + " ".join("{:02X}".format(i) for i in range(width)), "-" * (width*3 + 6)]
+        for i in range(0, len(data), width):
+            lines.append("{:04X} | ".format(i) + " ".join("{:02X}".format(b) for b in data[i:i+width]))
+        return "\n".join(lines)
 
     def wipe_eeprom(self):
         """Writes 0xff (255) to all bytes in eeprom, as it would have come from the factory"""
@@ -469,12 +544,7 @@ class BikeHornInterface():
                 t1_top = self.midi_to_counter_top(i)
                 t1_compare = piezo_func(t1_top)
                 t2_compare = boost_func(t1_top)
-                self._serial_port.write("~`~`p{}~{}~{}`~`~".format(t1_top, t1_compare, t2_compare).encode('UTF-8'))
-                
-                # Wait for acknowledge
-                response = self._serial_port.read_until("`~`~".encode('UTF-8'))
-                if "~`~`Ack`~`~" not in str(response):
-                    self._logging.error("Lost connection to horn - no acknowledge received")
+                if self._command(BikeHornInterface.COMMAND_PLAY, struct.pack("<HHB", t1_top, t1_compare, t2_compare)) is None:
                     self.abort()
             else:
                 self._logging.error("Lost connection to horn - serial port closed unexpectedly")
@@ -492,62 +562,58 @@ class BikeHornInterface():
 
     def _send_config(self, address, config):
         self._logging.info("Address: {}, Config: {}".format(address, config))
-        if self._serial_port.isOpen():
-            # Write to serial port
-            self._serial_port.write("~`~`w{}~".format(address).encode('UTF-8'))
-            for i, data in enumerate(config):
-                if self._serial_port.isOpen():
-                    self._logging.info('.', end="")
-                    if i != len(config)-1:
-                        self._serial_port.write("{}~".format(data).encode('UTF-8'))
-                    else:
-                        self._serial_port.write("{}".format(data).encode('UTF-8'))
-                        # Send done
-                        self._serial_port.write("`~`~".encode('UTF-8'))
-
-                    # Wait for acknowledge
-                    response1 = self._serial_port.read_until("~`~`W`~`~".encode('UTF-8'))
-                    if "~`~`W`~`~" not in str(response1):
-                        self._logging.error("Lost connection to horn - no intermediate acknowledge received")
-                        return False
-
-                else:
-                    self._logging.error("Lost connection to horn - serial port closed unexpectedly")
-                    return False
-            
-            # Wait for acknowledge
-            response2 = self._serial_port.read_until("`~`~".encode('UTF-8'))
-            if "~`~`Ack`~`~" not in str(response1 + response2):
-                self._logging.error("Lost connection to horn - no final acknowledge received")
+        # Send in blocks as large as a frame allows (2 bytes are needed for the address)
+        block_size = BikeHornInterface.FRAME_MAX_PAYLOAD - 2
+        for i in range(0, len(config), block_size):
+            self._logging.info('.', end="")
+            block = bytes(config[i:i+block_size])
+            if self._command(BikeHornInterface.COMMAND_WRITE, struct.pack("<H", address + i) + block) is None:
                 return False
-        else:
-            self._logging.error("Lost connection to horn - serial port closed unexpectedly")
-            return False
 
         self._logging.info("") # New line for dots
         return True
 
-    def _get_data_point(self, midi, boost, piezo):
-        if self._serial_port.isOpen():
-            # Write to serial port
-            t1_top = self.midi_to_counter_top(midi)
-            t1_compare = self.duty_to_counter_compare(piezo, t1_top)
-            t2_compare = self.duty_to_counter_compare(boost, BikeHornInterface.TIMER_2_TOP)
-            self._serial_port.write("~`~`p{}~{}~{}`~`~".format(t1_top, t1_compare, t2_compare).encode('UTF-8'))
-            
-            # Wait for acknowledge
-            response = self._serial_port.read_until("`~`~".encode('UTF-8'))
-            if "~`~`Ack`~`~" not in str(response):
-                self._logging.error("Lost connection to horn - no acknowledge received")
-                self.abort()
-                return 0
-            
-            time.sleep(BikeHornInterface.TEST_WAIT_TIME) # A short while to let things stabilise
-            return self._audio.get_level()
-        else:
-            self._logging.error("Lost connection to horn - serial port closed unexpectedly")
-            self.abort()
+    def _sweep_results(self, markers:list, recording:list, points_per_note:int, boost_count:int) -> list:
+        """Works out the loudness of each point in a sweep from the markers and recorded audio.
+
+        The horn's clock is not exactly the same speed as the computer's, so a line is fitted from the
+        horn's marker times to the times they arrived. Serial delays only ever make markers arrive late,
+        so the line is then moved down to the earliest arrivals.
 
+        Args:
+            markers (list): (horn time, arrival time) in seconds for each point played.
+            recording (list): (time, level) for each block of audio recorded.
+            points_per_note (int): The number of points tested for each note.
+            boost_count (int): The number of boost duty cycles tested for each note.
+
+        Returns:
+            list: The sound levels for each complete note, indexed as [midi][boost][piezo].
+        """
+        notes = len(markers) // points_per_note
+        if notes == 0:
+            return []
+
+        # Convert the horn's times to audio stream times
+        device = np.array([m[0] for m in markers])
+        host = np.array([m[1] for m in markers])
+        if len(markers) > 1 and np.ptp(device) > 0:
+            gradient, offset = np.polyfit(device, host, 1)
+        else:
+            gradient, offset = 1, host[0] - device[0]
+        offset += np.min(host - (gradient*device + offset))
+
+        # Average the audio level over the end of each point
+        times = np.array([r[0] for r in recording])
+        levels = np.array([r[1] for r in recording])
+        results = []
+        for i in range(notes * points_per_note):
+            start = gradient*(device[i] + BikeHornInterface.TEST_SETTLE_TIME) + offset
+            end = gradient*(device[i] + BikeHornInterface.TEST_DWELL_TIME) + offset
+            window = levels[(times >= start) & (times < end)]
+            results.append(float(np.mean(window)) if len(window) else 0)
+
+        piezo_count = points_per_note // boost_count
+        return [[results[(m*boost_count + b)*piezo_count:(m*boost_count + b + 1)*piezo_count] for b in range(boost_count)] for m in range(notes)]
 
     def _start_serial_port(self):
         """Attempts to open the serial port and talk to the horn.
@@ -563,11 +629,15 @@ class BikeHornInterface():
             return False
         
         if self._serial_port.isOpen():
-            response = self._serial_port.read_until("`~`~".encode('UTF-8'))
-            if "~`~`Ready`~`~" not in str(response):
+            # Opening the port resets the horn, which then sends a ready frame after the welcome message.
+            response = self._read_frame()
+            if response is None or response[0] != BikeHornInterface.RESPONSE_READY:
                 # Failure
                 self._logging.error("Did not get a response from the the horn")
                 return False
+            if response[1][0] != BikeHornInterface.PROTOCOL_VERSION:
+                self._logging.error("The optimiser sketch on the horn uses protocol version {}, but version {} is required. Please upload the latest optimiser sketch.".format(response[1][0], BikeHornInterface.PROTOCOL_VERSION))
+                return False
         else:
             # Port closed
             self._logging.error("Serial port is closed")
@@ -578,18 +648,81 @@ class BikeHornInterface():
     
     def _shut_up(self, require_response=True):
         if self._serial_port.isOpen():
-            self._serial_port.write("~`~`s`~`~".encode('UTF-8'))
-        
-            # Wait for acknowledge
             if require_response:
-                response = self._serial_port.read_until("`~`~".encode('UTF-8'))
-                if "~`~`Ack`~`~" not in str(response):
-                    self._logging.error("Lost connection to horn - no acknowledge received")
+                if self._command(BikeHornInterface.COMMAND_STOP) is None:
                     self.abort()
+            else:
+                self._send_frame(BikeHornInterface.COMMAND_STOP)
         elif require_response:
             self._logging.error("Lost connection to horn - serial port closed unexpectedly")
             self.abort()
 
+    def _send_frame(self, command:str, payload:bytes=b"") -> None:
+        """Sends a frame to the horn.
+
+        Args:
+            command (str): The command character.
+            payload (bytes, optional): The data to send with the command. Defaults to b"".
+        """
+        header = bytes([len(payload), ord(command)])
+        crc = binascii.crc_hqx(header + payload, 0) # CRC-16/XMODEM
+        self._serial_port.write(bytes([BikeHornInterface.FRAME_SYNC]) + header + payload + crc.to_bytes(2, "little"))
+
+    def _read_frame(self):
+        """Waits for a frame from the horn, skipping anything before it.
+
+        Returns:
+            tuple: (command, payload), or None if timed out or the CRC was wrong.
+        """
+        # Find the start
+        while True:
+            byte = self._serial_port.read(1)
+            if not byte:
+                return None
+            if byte[0] == BikeHornInterface.FRAME_SYNC:
+                break
+
+        header = self._serial_port.read(2)
+        if len(header) != 2:
+            return None
+        length = header[0]
+        rest = self._serial_port.read(length + 2)
+        if len(rest) != length + 2:
+            return None
+        payload = rest[:length]
+        if binascii.crc_hqx(header + payload, 0) != int.from_bytes(rest[length:], "little"):
+            self._logging.warning("Received a frame with an incorrect CRC")
+            return None
+        return chr(header[1]), payload
+
+    def _command(self, command:str, payload:bytes=b""):
+        """Sends a command and waits for the horn to acknowledge it.
+
+        Args:
+            command (str): The command character.
+            payload (bytes, optional): The data to send with the command. Defaults to b"".
+
+        Returns:
+            bytes: The data in the acknowledgement, or None on failure.
+        """
+        if not self._serial_port.isOpen():
+            self._logging.error("Lost connection to horn - serial port closed unexpectedly")
+            return None
+
+        self._send_frame(command, payload)
+        response = self._read_frame()
+        if response is None:
+            self._logging.error("Lost connection to horn - no acknowledge received")
+            return None
+        response_command, data = response
+        if response_command == BikeHornInterface.RESPONSE_NAK:
+            self._logging.error("The horn rejected command '{}' with error code {}".format(command, data[0] if data else None))
+            return None
+        if response_command != BikeHornInterface.RESPONSE_ACK:
+            self._logging.error("Unexpected response '{}' from the horn".format(response_command))
+            return None
+        return data
+
     def _shutdown(self, success=True):
         """Attempts to make the horn go quiet"""
         self._logging.info("Attempted to shut down")
@@ -606,6 +739,19 @@ class BikeHornInterface():
         if self._gui:
             self._gui.test_finished(success)
 
+class TimeUnwrapper():
+    """Converts a 32 bit micros() count that wraps around every 71 minutes into a time in seconds that does not
+    """
+    def __init__(self):
+        self._last = None
+        self._wraps = 0
+
+    def unwrap(self, micros:int) -> float:
+        if self._last is not None and micros < self._last:
+            self._wraps += 1
+        self._last = micros
+        return (self._wraps * 2**32 + micros) / 1e6
+
 class LinearFunction():
     """Class for a linear function
     """
@@ -1788,8 +1934,8 @@ as expected.""").grid(padx=10, pady=10, sticky=tk.W)
             timer2_contents = str(self._optimiser.get_t2_optimised())
             self._replace_text_contents(self._timer1_human_readable, timer1_contents)
             self._replace_text_contents(self._timer2_human_readable, timer2_contents)
-            t1_list = list(self._optimiser.get_t1_optimised().to_bytes())
-            t2_list = list(self._optimiser.get_t2_optimised().to_bytes())
+            t1_list = list(BikeHornInterface.to_record(BikeHornInterface.RECORD_TIMER1_PIECEWISE, self._optimiser.get_t1_optimised().to_bytes()))
+            t2_list = list(BikeHornInterface.to_record(BikeHornInterface.RECORD_TIMER2_PIECEWISE, self._optimiser.get_t2_optimised().to_bytes()))
             compiled_contents = """Starting from EEPROM address {} using {} bytes:
 {}
 
@@ -2190,6 +2336,7 @@ class AudioLevels():
         self._stream = sd.InputStream(callback=self._audio_callback, blocksize=500)
         self.set_gui(gui)
         self._stop_required = False
+        self._recording = None
 
     def set_gui(self, gui=None) -> None:
         self._gui = gui
@@ -2212,6 +2359,24 @@ class AudioLevels():
     def get_level(self):
         return self._audio_level
 
+    def stream_time(self) -> float:
+        """Returns the current time of the audio stream (s), in the same units as the recording"""
+        return self._stream.time
+
+    def start_recording(self):
+        """Starts keeping the level of every block of audio along with the time it was recorded"""
+        self._recording = []
+
+    def get_recording(self) -> list:
+        """Returns the (time, level) pairs recorded so far"""
+        return list(self._recording) if self._recording is not None else []
+
+    def stop_recording(self) -> list:
+        """Stops recording and returns the (time, level) pairs recorded"""
+        recording = self.get_recording()
+        self._recording = None
+        return recording
+
     def _audio_callback(self, indata, frames, time, status):
         if self._stop_required:
             print("Stopping audio")
@@ -2219,6 +2384,9 @@ class AudioLevels():
             raise sd.CallbackAbort()
         
         self._audio_level = np.linalg.norm(indata) * 10
+        if self._recording is not None:
+            # Some audio APIs do not provide the ADC time, in which case use the current time
+            self._recording.append((time.inputBufferAdcTime or self._stream.time, self._audio_level))
         if self._gui:
             self._gui.set_sound_level(self._audio_level)
 
@@ -2,41 +2,105 @@
  * @file OptimiserSketch.ino
  * @author Jotham Gates
  * @brief Sketch for use with the BikeHornOptimiser tool for tuning the horn to get best performance
- * @date 2021-12-30
+ * @date 2026-10-18
  * 
  * Upload this sketch to the horn and run BikeHornOptimiser.py.
  * NOTE: This script DOES NOT include any low power features. When you are finished, either remove
  * the batteries or reflash the proper BikeHorn sketch (that does have power saving features),
  * otherwise you will end up with flat batteries.
+ * 
+ * Communication uses binary frames (all numbers little endian):
+ *   FRAME_SYNC | payload length (1 byte) | command (1 byte) | payload | CRC16 (2 bytes)
+ * The CRC is CRC-16/XMODEM over the length, command and payload. Every command frame is answered with a
+ * RESPONSE_ACK frame (containing any data requested) or a RESPONSE_NAK frame (containing an error code).
+ * See the Readme for the commands.
+ * 
+ * A whole test can be sent as a sweep plan. The sketch then plays every point in the plan by itself, timing
+ * each point from micros() and sending a RESPONSE_MARKER frame as each one starts so that the computer only
+ * needs to record the audio and line it up with the markers afterwards.
  */
 
 #include <EEPROM.h>
-#include <stdio.h>
+#include <util/crc16.h>
 
 #define PIEZO_PIN 9 // Fixed as PB1 (Pin 9 on Arduino Nano)
 #define BOOST_PIN 11 // Fixed as PB3 (Pin 11 on Arduino Nano)
 #define LED_EXTERNAL 7
 #define SERIAL_BAUD 38400
 
-#define VERSION "1.0.0"
+#define VERSION "2.1.0"
 #define WELCOME_MSG "Bike horn OPTIMISER V" VERSION " started. Compiled " __TIME__ ", " __DATE__
 
-static FILE uartout = {0}; // https://playground.arduino.cc/Main/Printf/
+// Protocol
+#define PROTOCOL_VERSION 3
+#define FRAME_SYNC 0xa5
+#define FRAME_MAX_PAYLOAD 64
+#define FRAME_TIMEOUT 100 // ms to wait for the rest of a frame after the sync byte.
+
+// Commands
+#define COMMAND_PLAY 'p' // t1Top (2), t1Compare (2), t2Compare (1)
+#define COMMAND_STOP 's'
+#define COMMAND_WRITE 'w' // address (2), data (up to FRAME_MAX_PAYLOAD - 2)
+#define COMMAND_READ 'r' // address (2), length (1, up to FRAME_MAX_PAYLOAD)
+#define COMMAND_SWEEP 'x' // midi, boost and piezo ranges (start, count, step, 1 each), dwell ms (2), cooldown s (2)
+
+// Responses
+#define RESPONSE_READY 'R' // Sent on startup. Protocol version (1), EEPROM size (2), max payload (1)
+#define RESPONSE_ACK 'A'
+#define RESPONSE_NAK 'N' // Error code (1)
+#define RESPONSE_MARKER 'M' // Sweep point started. Index (2), micros (4), midi (1), boost (1), piezo (1)
+#define RESPONSE_COOLDOWN 'C' // Sweep cooldown started. micros (4)
+#define RESPONSE_DONE 'D' // Sweep finished or aborted. Points played (2), micros (4)
+
+// Error codes
+#define ERROR_CRC 1
+#define ERROR_LENGTH 2
+#define ERROR_COMMAND 3
+#define ERROR_ADDRESS 4
+#define ERROR_RANGE 5
+
+// Sweep limits
+#define SWEEP_MIDI_MIN 23 // Lowest note timer 1 can play with a prescaler of 8
+#define SWEEP_MIDI_MAX 127
+#define SWEEP_DUTY_MAX 100
+#define SWEEP_COOLDOWN_MAX 3600 // s, so that the time in us fits in 32 bits
+
+/**
+ * @brief One axis of a sweep plan.
+ * 
+ */
+struct SweepRange {
+    uint8_t start;
+    uint8_t count;
+    uint8_t step;
+
+    /**
+     * @brief Returns the value of the given step.
+     * 
+     */
+    inline uint8_t value(uint8_t i) const {
+        return start + i * step;
+    }
+
+    /**
+     * @brief Checks that every value is between min and max.
+     * 
+     */
+    bool isValid(uint8_t min, uint8_t max) const {
+        return count != 0 && start >= min && start + (uint16_t)(count - 1) * step <= max;
+    }
+};
+
+uint8_t payload[FRAME_MAX_PAYLOAD];
 
 /**
  * @brief Initial setup and signalling to the computer
  * 
  */
 void setup() {
-    // Fprintf stuff
-    // Fill in the UART file descriptor with pointer to writer.
-    fdev_setup_stream (&uartout, uart_putchar, NULL, _FDEV_SETUP_WRITE);
-    // The uart is the standard output device STDOUT.
-    stdout = &uartout ;
-
     // Initial setup
     Serial.begin(SERIAL_BAUD);
-    Serial.setTimeout(__LONG_MAX__);
+    Serial.setTimeout(FRAME_TIMEOUT);
     pinMode(LED_BUILTIN, OUTPUT);
     pinMode(LED_EXTERNAL, OUTPUT);
     pinMode(PIEZO_PIN, OUTPUT);
@@ -45,8 +109,11 @@ void setup() {
     digitalWrite(LED_EXTERNAL, HIGH);
     Serial.println(F(WELCOME_MSG));
 
-    // Wait for the computer
-    Serial.println(F("~`~`Ready`~`~"));
+    // Tell the computer we are ready
+    payload[0] = PROTOCOL_VERSION;
+    putWord(&payload[1], EEPROM.length());
+    payload[3] = FRAME_MAX_PAYLOAD;
+    sendFrame(RESPONSE_READY, payload, 4);
 }
 
 /**
@@ -54,51 +121,67 @@ void setup() {
  * 
  */
 void loop() {
-    // Wait for the start of the message
+    // Wait for the start of the frame
     digitalWrite(LED_EXTERNAL, HIGH);
-    Serial.find("~`~`");
-    while(!Serial.available());
-    char instruction = Serial.read();
+    while (waitByte() != FRAME_SYNC) {}
     digitalWrite(LED_EXTERNAL, LOW);
 
-    bool simpleAck = true;
-
-    // Tune playing settings
-    uint16_t t1Top, t1Compare;
-    uint8_t t2Compare;
+    // Get the rest of the frame
+    uint8_t header[2];
+    if (Serial.readBytes(header, 2) != 2) {
+        return; // Timed out, wait for the next frame.
+    }
+    uint8_t length = header[0];
+    char command = header[1];
+    if (length > FRAME_MAX_PAYLOAD) {
+        sendError(ERROR_LENGTH);
+        return;
+    }
+    uint8_t crcBytes[2];
+    if (Serial.readBytes(payload, length) != length || Serial.readBytes(crcBytes, 2) != 2) {
+        return; // Timed out
+    }
+    uint16_t crc = crcUpdate(crcUpdate(0, header, 2), payload, length);
+    if (crc != getWord(crcBytes)) {
+        sendError(ERROR_CRC);
+        return;
+    }
 
     // Interpret the instruction
-    switch(instruction) {
-        case 'p':
+    switch(command) {
+        case COMMAND_PLAY:
             // Play a note
-            t1Top = Serial.parseInt();
-            Serial.find('~');
-            t1Compare = Serial.parseInt();
-            Serial.find('~');
-            t2Compare = Serial.parseInt();
-
-            playNote(t1Top, t1Compare, t2Compare);
+            if (length != 5) {
+                sendError(ERROR_LENGTH);
+                return;
+            }
+            playNote(getWord(&payload[0]), getWord(&payload[2]), payload[4]);
+            sendFrame(RESPONSE_ACK, payload, 0);
             break;
-        case 's':
+
+        case COMMAND_STOP:
             // Stop all timers and noise
             stop();
+            sendFrame(RESPONSE_ACK, payload, 0);
             break;
-        case 'w':
-            // Write a eeprom bytes
-            writeStream();
-            simpleAck = false;
+
+        case COMMAND_WRITE:
+            // Write a block of eeprom bytes
+            writeBlock(length);
+            break;
+
+        case COMMAND_READ:
+            // Read a block of eeprom bytes
+            readBlock(length);
+            break;
+
+        case COMMAND_SWEEP:
+            // Play a whole test by ourselves
+            sweep(length);
             break;
-        case 'r':
-            // Read the specified number of eeprom bytes from an address
-            dumpEEPROM();
-            
-    }
 
-    // Acknowledge
-    if(simpleAck) {
-        // Wait for the end of the message
-        Serial.find("`~`~");
-        Serial.println(F("~`~`Ack`~`~"));
+        default:
+            sendError(ERROR_COMMAND);
     }
 }
 
@@ -135,70 +218,220 @@ void stop() {
     digitalWrite(PIEZO_PIN, LOW);
 }
 
-void writeStream() {
-    uint16_t address = Serial.parseInt();
-    bool done = false;
-    while(!done) {
-        char input = waitByte();
-        if(input == '~') {
-            // Get and write a byte
-            uint8_t data = Serial.parseInt();
-            EEPROM.update(address, data);
-            address++;
-            Serial.println(F("~`~`W`~`~"));
-        } else if(input == '`') {
-            input = waitByte();
-            if(input == '~') {
-                input = waitByte();
-                if(input == '`') {
-                    input = waitByte();
-                    if(input == '~') {
-                        done = true;
-                    }
-                }
-            }
-        }
+/**
+ * @brief Writes the data in a write command to EEPROM and acknowledges it.
+ * Bytes that are already correct are not rewritten.
+ * 
+ * @param length the length of the payload.
+ */
+void writeBlock(uint8_t length) {
+    if (length < 2) {
+        sendError(ERROR_LENGTH);
+        return;
     }
-    Serial.println(F("~`~`Ack`~`~"));
+    uint16_t address = getWord(payload);
+    uint8_t count = length - 2;
+    if (address + count > EEPROM.length()) {
+        sendError(ERROR_ADDRESS);
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        EEPROM.update(address + i, payload[2 + i]);
+    }
+    sendFrame(RESPONSE_ACK, payload, 0);
 }
 
-char waitByte() {
-    while(!Serial.available()) {}
-    return Serial.read();
+/**
+ * @brief Sends a block of EEPROM in response to a read command.
+ * 
+ * @param length the length of the payload.
+ */
+void readBlock(uint8_t length) {
+    if (length != 3 || payload[2] > FRAME_MAX_PAYLOAD) {
+        sendError(ERROR_LENGTH);
+        return;
+    }
+    uint16_t address = getWord(payload);
+    uint8_t count = payload[2];
+    if (address + count > EEPROM.length()) {
+        sendError(ERROR_ADDRESS);
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        payload[i] = EEPROM.read(address + i);
+    }
+    sendFrame(RESPONSE_ACK, payload, count);
 }
 
+/**
+ * @brief Checks and runs a sweep plan, returning when it has finished or any
+ * byte is received from the computer (which is then handled as normal).
+ * 
+ * The points are played with midi as the outer loop, then boost, then piezo.
+ * The start of each point is scheduled a fixed dwell after the previous, so the
+ * time taken to send markers does not add up over a long sweep.
+ * 
+ * @param length the length of the payload.
+ */
+void sweep(uint8_t length) {
+    if (length != 13) {
+        sendError(ERROR_LENGTH);
+        return;
+    }
 
-void dumpEEPROM() {
-    const char WIDTH = 16;
-    const int EEPROM_SIZE = 1024;
-
-    // Header row
-    printf("     | ");
-    for(int i = 0; i < WIDTH; i++) {
-        printf("%02X ", i);
+    // Copy the plan out of the payload, as it is reused for the markers
+    SweepRange midi = {payload[0], payload[1], payload[2]};
+    SweepRange boost = {payload[3], payload[4], payload[5]};
+    SweepRange piezo = {payload[6], payload[7], payload[8]};
+    uint32_t dwell = getWord(&payload[9]) * 1000UL;
+    uint16_t cooldownSeconds = getWord(&payload[11]);
+    uint32_t cooldown = cooldownSeconds * 1000000UL;
+    if (!midi.isValid(SWEEP_MIDI_MIN, SWEEP_MIDI_MAX) || !boost.isValid(0, SWEEP_DUTY_MAX) || !piezo.isValid(0, SWEEP_DUTY_MAX) || cooldownSeconds > SWEEP_COOLDOWN_MAX) {
+        sendError(ERROR_RANGE);
+        return;
     }
-    printf("\n");
-    for(int i = 0; i < WIDTH*3+7; i++) {
-        printf("-", i);
+    sendFrame(RESPONSE_ACK, payload, 0);
+
+    uint16_t index = 0;
+    uint32_t start = micros();
+    for (uint8_t m = 0; m < midi.count; m++) {
+        uint8_t note = midi.value(m);
+        uint16_t t1Top = F_CPU / 8 / (440.0 * pow(2, (note - 69) / 12.0)) + 0.5;
+        for (uint8_t b = 0; b < boost.count; b++) {
+            uint8_t t2Compare = dutyToCompare(boost.value(b), 255);
+            for (uint8_t p = 0; p < piezo.count; p++) {
+                // Play the point and tell the computer when it started
+                playNote(t1Top, dutyToCompare(piezo.value(p), t1Top), t2Compare);
+                putWord(&payload[0], index);
+                putLong(&payload[2], start);
+                payload[6] = note;
+                payload[7] = boost.value(b);
+                payload[8] = piezo.value(p);
+                sendFrame(RESPONSE_MARKER, payload, 9);
+                index++;
+                if (!sweepWait(start, dwell)) {
+                    sweepDone(index);
+                    return;
+                }
+                start += dwell;
+            }
+        }
+
+        // Let the horn cool off between notes
+        stop();
+        if (m + 1 != midi.count) {
+            putLong(payload, start);
+            sendFrame(RESPONSE_COOLDOWN, payload, 4);
+            if (!sweepWait(start, cooldown)) {
+                sweepDone(index);
+                return;
+            }
+            start += cooldown;
+        }
     }
+    sweepDone(index);
+}
 
-    // Body
-    for(int i = 0; i < EEPROM_SIZE; i += WIDTH) {
-        printf("\n%04X | ", i);
-        // Row
-        for(int j = 0; j < WIDTH; j++) {
-            printf("%02X ", EEPROM.read(i+j));
+/**
+ * @brief Waits until a given time after the start of the current sweep step.
+ * 
+ * @param start the time the step started in us.
+ * @param duration how long to wait for in us.
+ * @return true if the wait finished.
+ * @return false if the computer sent something and the sweep should be
+ *               aborted (the bytes are left for loop() to handle).
+ */
+bool sweepWait(uint32_t start, uint32_t duration) {
+    while (micros() - start < duration) {
+        if (Serial.available()) {
+            return false;
         }
     }
-    printf("\n");
+    return true;
+}
+
+/**
+ * @brief Stops making noise and tells the computer the sweep has ended.
+ * 
+ * @param played the number of points played. This will be less than the
+ *               number in the plan if the sweep was aborted.
+ */
+void sweepDone(uint16_t played) {
+    stop();
+    putWord(&payload[0], played);
+    putLong(&payload[2], micros());
+    sendFrame(RESPONSE_DONE, payload, 6);
 }
 
 /**
- * @brief output function for printf
- * From https://playground.arduino.cc/Main/Printf/
+ * @brief Converts a duty cycle to a timer compare value, rounding to the
+ * nearest count.
  * 
+ * @param duty the duty cycle in %.
+ * @param top the value the timer counts to.
+ * @return uint16_t the compare value.
  */
-static int uart_putchar (char c, FILE *stream) {
-    Serial.write(c) ;
-    return 0 ;
+uint16_t dutyToCompare(uint8_t duty, uint16_t top) {
+    return ((uint32_t)top * duty + 50) / 100;
+}
+
+/**
+ * @brief Sends a frame to the computer.
+ * 
+ * @param command the command or response.
+ * @param data the payload.
+ * @param length the length of the payload.
+ */
+void sendFrame(char command, const uint8_t *data, uint8_t length) {
+    uint8_t header[2] = {length, (uint8_t)command};
+    uint16_t crc = crcUpdate(crcUpdate(0, header, 2), data, length);
+    uint8_t crcBytes[2];
+    putWord(crcBytes, crc);
+    Serial.write(FRAME_SYNC);
+    Serial.write(header, 2);
+    Serial.write(data, length);
+    Serial.write(crcBytes, 2);
+}
+
+/**
+ * @brief Sends a RESPONSE_NAK frame.
+ * 
+ * @param error the error code.
+ */
+void sendError(uint8_t error) {
+    sendFrame(RESPONSE_NAK, &error, 1);
+}
+
+/**
+ * @brief Adds bytes to a CRC-16/XMODEM.
+ * 
+ * @param crc the CRC so far (start with 0).
+ * @param data the bytes to add.
+ * @param length the number of bytes.
+ * @return uint16_t the new CRC.
+ */
+uint16_t crcUpdate(uint16_t crc, const uint8_t *data, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        crc = _crc_xmodem_update(crc, data[i]);
+    }
+    return crc;
+}
+
+uint16_t getWord(const uint8_t *data) {
+    return data[0] | (uint16_t)data[1] << 8;
+}
+
+void putWord(uint8_t *data, uint16_t value) {
+    data[0] = value;
+    data[1] = value >> 8;
+}
+
+void putLong(uint8_t *data, uint32_t value) {
+    putWord(&data[0], value);
+    putWord(&data[2], value >> 16);
+}
+
+uint8_t waitByte() {
+    while(!Serial.available()) {}
+    return Serial.read();
 }
\ No newline at end of file